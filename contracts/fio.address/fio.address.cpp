@@ -12,6 +12,8 @@
 #include <fio.token/include/fio.token/fio.token.hpp>
 #include <eosiolib/asset.hpp>
 #include <fio.request.obt/fio.request.obt.hpp> //TEMP FOR XFERADDRESS
+#include <set>
+#include <map>
 
 namespace fioio {
 
@@ -32,6 +34,11 @@ namespace fioio {
         config appConfig;
         recordobt_table recordObtTable; //TEMP FOR XFERADDRESS
         fiorequest_contexts_table fiorequestContextsTable; //TEMP FOR XFERADDRESS
+        burncursor_singleton burnCursor;
+        burnconfig_singleton burnConfig;
+        pubaddrs_table pubaddrs;
+        addrmigr_singleton addrMigration;
+        domcntmigr_singleton domcntMigration;
 
     public:
         using contract::contract;
@@ -48,7 +55,12 @@ namespace fioio {
                                                                         producers(SYSTEMACCOUNT, SYSTEMACCOUNT.value),
                                                                         lockedTokensTable(SYSTEMACCOUNT,SYSTEMACCOUNT.value),
                                                                         recordObtTable(REQOBTACCOUNT, REQOBTACCOUNT.value), //TEMP FOR XFERADDRESS
-                                                                        fiorequestContextsTable(REQOBTACCOUNT, REQOBTACCOUNT.value){ //TEMP FOR XFERADDRESS
+                                                                        fiorequestContextsTable(REQOBTACCOUNT, REQOBTACCOUNT.value), //TEMP FOR XFERADDRESS
+                                                                        burnCursor(_self, _self.value),
+                                                                        burnConfig(_self, _self.value),
+                                                                        pubaddrs(_self, _self.value),
+                                                                        addrMigration(_self, _self.value),
+                                                                        domcntMigration(_self, _self.value){
             configs_singleton configsSingleton(FeeContract, FeeContract.value);
             appConfig = configsSingleton.get_or_default(config());
         }
@@ -160,6 +172,92 @@ namespace fioio {
             return DEFAULTBUNDLEAMT;
         }
 
+        //adjusts the number of fio addresses on the domain, domains registered before the count was
+        //added have no count and are left alone until migrdomcnt sets it.
+        inline void update_domain_address_count(const uint128_t &domainhash, const int64_t delta) {
+            auto domainsbyname = domains.get_index<"byname"_n>();
+            auto domains_iter = domainsbyname.find(domainhash);
+
+            if (domains_iter != domainsbyname.end() && domains_iter->address_count.has_value()) {
+                domainsbyname.modify(domains_iter, _self, [&](struct domain &d) {
+                    d.address_count.emplace(d.address_count.value() + delta);
+                });
+            }
+        }
+
+        inline uint128_t pubaddress_token_hash(const string &token_code, const string &chain_code) {
+            return string_to_uint128_hash((token_code + ":" + chain_code).c_str());
+        }
+
+        inline void add_pub_address(const uint128_t &namehash, const string &token_code, const string &chain_code,
+                                    const string &public_address, const name &payer) {
+            pubaddrs.emplace(payer, [&](struct pubaddress &p) {
+                p.id = pubaddrs.available_primary_key();
+                p.namehash = namehash;
+                p.token_code = token_code;
+                p.chain_code = chain_code;
+                p.public_address = public_address;
+                p.nametokenhash = pubaddress_key(namehash, pubaddress_token_hash(token_code, chain_code));
+            });
+        }
+
+        /***
+         * This method moves the addresses of a fioname row registered before the pubaddrs table
+         * into the pubaddrs table, rows already migrated are left as is. the fioname row keeps its
+         * payer, the ram freed by clearing its addresses goes back to whoever registered it.
+         * @param fionameid   the id of the fioname row
+         * @param payer   the account paying for the ram of the new pubaddrs rows, the signing actor
+         *                of the address actions, or _self in migraddrs where the owner did not sign
+         * @return the number of public addresses mapped to the fio address.
+         */
+        uint64_t migrate_pub_addresses(const uint64_t &fionameid, const name &payer) {
+            auto fioname_iter = fionames.find(fionameid);
+            if (fioname_iter->pub_address_count.has_value()) {
+                return fioname_iter->pub_address_count.value();
+            }
+
+            auto pubaddrsbynametoken = pubaddrs.get_index<"bynametoken"_n>();
+            uint64_t count = 0;
+            for (const auto &tpa : fioname_iter->addresses) {
+                //the first entry for a token and chain code is the one lookups have always returned.
+                const checksum256 key = pubaddress_key(fioname_iter->namehash,
+                                                       pubaddress_token_hash(tpa.token_code, tpa.chain_code));
+                if (pubaddrsbynametoken.find(key) == pubaddrsbynametoken.end()) {
+                    add_pub_address(fioname_iter->namehash, tpa.token_code, tpa.chain_code, tpa.public_address, payer);
+                    count++;
+                }
+            }
+
+            fionames.modify(fioname_iter, same_payer, [&](struct fioname &a) {
+                a.addresses.clear();
+                a.pub_address_count.emplace(count);
+            });
+            return count;
+        }
+
+        //the rows burnexpired erases for a fio address, the fioname row and its pubaddrs rows.
+        inline uint64_t burn_rows(const fioname &fn) {
+            return 1 + (fn.pub_address_count.has_value() ? fn.pub_address_count.value() : 0);
+        }
+
+        //removes the public addresses of the fio address, optionally keeping the FIO public key.
+        //returns the number of public addresses left.
+        uint64_t erase_pub_addresses(const uint128_t &namehash, const bool &keepfio) {
+            auto pubaddrsbynametoken = pubaddrs.get_index<"bynametoken"_n>();
+            auto pubaddr_iter = pubaddrsbynametoken.lower_bound(pubaddress_key(namehash, 0));
+            uint64_t remaining = 0;
+
+            while (pubaddr_iter != pubaddrsbynametoken.end() && pubaddr_iter->namehash == namehash) {
+                if (keepfio && pubaddr_iter->token_code == "FIO" && pubaddr_iter->chain_code == "FIO") {
+                    remaining++;
+                    pubaddr_iter++;
+                } else {
+                    pubaddr_iter = pubaddrsbynametoken.erase(pubaddr_iter);
+                }
+            }
+            return remaining;
+        }
+
         uint32_t fio_address_update( const name &actor, const name &owner, const uint64_t max_fee, const FioAddress &fa,
                                     const string &tpid) {
 
@@ -215,15 +313,21 @@ namespace fioio {
             fionames.emplace(actor, [&](struct fioname &a) {
                 a.id = id;
                 a.name = fa.fioaddress;
-                a.addresses = pubaddresses;
                 a.namehash = nameHash;
                 a.domain = fa.fiodomain;
                 a.domainhash = domainHash;
                 a.expiration = expiration_time;
                 a.owner_account = owner.value;
                 a.bundleeligiblecountdown = getBundledAmount();
+                a.pub_address_count.emplace(0);
             });
 
+            if (domains_iter->address_count.has_value()) {
+                domainsbyname.modify(domains_iter, _self, [&](struct domain &d) {
+                    d.address_count.emplace(d.address_count.value() + 1);
+                });
+            }
+
             uint64_t fee_amount = chain_data_update(fa.fioaddress, pubaddresses, max_fee, fa, actor, owner,
                                                     true, tpid);
 
@@ -256,6 +360,7 @@ namespace fioio {
                 d.domainhash = domainHash;
                 d.expiration = expiration_time;
                 d.account = owner.value;
+                d.address_count.emplace(0);
             });
             return expiration_time;
         }
@@ -294,13 +399,14 @@ namespace fioio {
             fio_400_assert(present_time <= expiration, "domain", fa.fiodomain, "FIO Domain expired",
                            ErrorDomainExpired);
 
-            tokenpubaddr tempStruct;
             string token;
             string chaincode;
             string public_address;
 
+            uint64_t count = migrate_pub_addresses(fioname_iter->id, actor);
+            auto pubaddrsbynametoken = pubaddrs.get_index<"bynametoken"_n>();
+
             for(auto tpa = pubaddresses.begin(); tpa != pubaddresses.end(); ++tpa) {
-                bool wasFound = false;
                 token = tpa->token_code.c_str();
                 chaincode = tpa->chain_code.c_str();
                 public_address = tpa->public_address.c_str();
@@ -314,27 +420,23 @@ namespace fioio {
                                "Invalid public address format",
                                ErrorChainAddressEmpty);
 
-                int idx = 0;
-                for( auto it = fioname_iter->addresses.begin(); it != fioname_iter->addresses.end(); ++it ) {
-                    if( (it->token_code == token) && (it->chain_code == chaincode) && it->public_address == public_address ){
-                        wasFound = true;
-                        break;
-                    }
-                    idx++;
-                }
-                fio_400_assert(wasFound, "public_address", public_address, "Invalid public address",
+                auto pubaddr_iter = pubaddrsbynametoken.find(pubaddress_key(nameHash, pubaddress_token_hash(token, chaincode)));
+                fio_400_assert(pubaddr_iter != pubaddrsbynametoken.end() && pubaddr_iter->public_address == public_address,
+                               "public_address", public_address, "Invalid public address",
                                ErrorInvalidFioNameFormat);
 
-                namesbyname.modify(fioname_iter, actor, [&](struct fioname &a) {
-                    a.addresses.erase(a.addresses.begin()+idx);
-                });
-
+                pubaddrsbynametoken.erase(pubaddr_iter);
+                count--;
             }
 
+            namesbyname.modify(fioname_iter, actor, [&](struct fioname &a) {
+                a.pub_address_count.emplace(count);
+            });
+
             uint64_t fee_amount = 0;
 
             //begin new fees, bundle eligible fee logic
-            const uint128_t endpoint_hash = string_to_uint128_hash(REMOVE_PUB_ADDRESS_ENDPOINT);
+            const uint128_t endpoint_hash = REMOVE_PUB_ADDRESS_ENDPOINT_HASH;
 
             auto fees_by_endpoint = fiofees.get_index<"byendpoint"_n>();
             auto fee_iter = fees_by_endpoint.find(endpoint_hash);
@@ -411,36 +513,17 @@ namespace fioio {
             fio_400_assert(present_time <= expiration, "domain", fa.fiodomain, "FIO Domain expired",
                            ErrorDomainExpired);
 
-            int idx = 0;
-            bool wasFound = false;
-            for (auto it = fioname_iter->addresses.begin(); it != fioname_iter->addresses.end(); ++it) {
-                if ((it->token_code == "FIO") && (it->chain_code == "FIO")) {
-                    wasFound = true;
-                    break;
-                }
-                idx++;
-            }
-
-            if (!wasFound) {//remove em all
-                namesbyname.modify(fioname_iter, actor, [&](struct fioname &a) {
-                    a.addresses.clear();
-                });
-            } else {
-                namesbyname.modify(fioname_iter, actor, [&](struct fioname &a) {
-                    a.addresses.erase(a.addresses.begin() + (idx + 1), a.addresses.end());
-                });
+            migrate_pub_addresses(fioname_iter->id, actor);
+            const uint64_t remaining = erase_pub_addresses(nameHash, true);
 
-                if (idx > 0) {
-                    namesbyname.modify(fioname_iter, actor, [&](struct fioname &a) {
-                        a.addresses.erase(a.addresses.begin(), a.addresses.begin() + idx);
-                    });
-                }
-            }
+            namesbyname.modify(fioname_iter, actor, [&](struct fioname &a) {
+                a.pub_address_count.emplace(remaining);
+            });
 
             uint64_t fee_amount = 0;
 
             //begin new fees, bundle eligible fee logic
-            const uint128_t endpoint_hash = string_to_uint128_hash(REMOVE_ALL_PUB_ENDPOINT);
+            const uint128_t endpoint_hash = REMOVE_ALL_PUB_ENDPOINT_HASH;
 
             auto fees_by_endpoint = fiofees.get_index<"byendpoint"_n>();
             auto fee_iter = fees_by_endpoint.find(endpoint_hash);
@@ -516,12 +599,14 @@ namespace fioio {
             fio_400_assert(present_time <= expiration, "domain", fa.fiodomain, "FIO Domain expired",
                            ErrorDomainExpired);
 
-            tokenpubaddr tempStruct;
             string token;
             string chaincode;
 
+            const uint64_t initialcount = migrate_pub_addresses(fioname_iter->id, actor);
+            uint64_t count = initialcount;
+            auto pubaddrsbynametoken = pubaddrs.get_index<"bynametoken"_n>();
+
             for(auto tpa = pubaddresses.begin(); tpa != pubaddresses.end(); ++tpa) {
-                bool wasFound = false;
                 token = tpa->token_code.c_str();
                 chaincode = tpa->chain_code.c_str();
 
@@ -533,39 +618,26 @@ namespace fioio {
                                "Invalid public address format",
                                ErrorChainAddressEmpty);
 
-                auto it = std::find_if(fioname_iter->addresses.begin(), fioname_iter->addresses.end(),
-                                       find_token(token));
-                if ((it->token_code == token) && (it->chain_code == chaincode)) {
-                    namesbyname.modify(fioname_iter, actor, [&](struct fioname &a) {
-                        a.addresses[it - fioname_iter->addresses.begin()].public_address = tpa->public_address;
+                auto pubaddr_iter = pubaddrsbynametoken.find(pubaddress_key(nameHash, pubaddress_token_hash(token, chaincode)));
+                if (pubaddr_iter != pubaddrsbynametoken.end()) {
+                    pubaddrsbynametoken.modify(pubaddr_iter, actor, [&](struct pubaddress &p) {
+                        p.public_address = tpa->public_address;
                     });
-                    wasFound = true;
-                } else if (it->token_code == token && it->chain_code != chaincode) {
-                    for (auto it = fioname_iter->addresses.begin(); it != fioname_iter->addresses.end(); ++it) {
-                        if ((it->token_code == token) && (it->chain_code == chaincode)) {
-                            namesbyname.modify(fioname_iter, actor, [&](struct fioname &a) {
-                                a.addresses[it - fioname_iter->addresses.begin()].public_address = tpa->public_address;
-                            });
-                            wasFound = true;
-                            break;
-                        }
-                    }
-                }
-
-                if(!wasFound){
-                    fio_400_assert(fioname_iter->addresses.size() != MAX_SET_ADDRESSES, "token_code", tpa->token_code, "Maximum token codes mapped to single FIO Address reached. Only 200 can be mapped.",
+                } else {
+                    fio_400_assert(count != MAX_SET_ADDRESSES, "token_code", tpa->token_code, "Maximum token codes mapped to single FIO Address reached. Only 200 can be mapped.",
                                    ErrorInvalidFioNameFormat); // Don't forget to set the error amount if/when changing MAX_SET_ADDRESSES
 
-                    tempStruct.public_address = tpa->public_address;
-                    tempStruct.token_code = tpa->token_code;
-                    tempStruct.chain_code = tpa->chain_code;
-
-                    namesbyname.modify(fioname_iter, actor, [&](struct fioname &a) {
-                        a.addresses.push_back(tempStruct);
-                    });
+                    add_pub_address(nameHash, tpa->token_code, tpa->chain_code, tpa->public_address, actor);
+                    count++;
                 }
             }
 
+            if (count != initialcount) {
+                namesbyname.modify(fioname_iter, actor, [&](struct fioname &a) {
+                    a.pub_address_count.emplace(count);
+                });
+            }
+
             uint64_t fee_amount = 0;
 
             if (isFIO) {
@@ -573,7 +645,7 @@ namespace fioio {
             }
 
             //begin new fees, bundle eligible fee logic
-            const uint128_t endpoint_hash = string_to_uint128_hash(ADD_PUB_ADDRESS_ENDPOINT);
+            const uint128_t endpoint_hash = ADD_PUB_ADDRESS_ENDPOINT_HASH;
 
             auto fees_by_endpoint = fiofees.get_index<"byendpoint"_n>();
             auto fee_iter = fees_by_endpoint.find(endpoint_hash);
@@ -677,7 +749,7 @@ namespace fioio {
             fioio::convertfiotime(expiration_time, &timeinfo);
             std::string timebuffer = fioio::tmstringformat(timeinfo);
 
-            const uint128_t endpoint_hash = string_to_uint128_hash(REGISTER_ADDRESS_ENDPOINT);
+            const uint128_t endpoint_hash = REGISTER_ADDRESS_ENDPOINT_HASH;
 
             auto fees_by_endpoint = fiofees.get_index<"byendpoint"_n>();
             auto fee_iter = fees_by_endpoint.find(endpoint_hash);
@@ -717,6 +789,149 @@ namespace fioio {
            send_response(response_string.c_str());
         }
 
+        /*******
+         * This action registers a batch of fio addresses on one domain. The domain, fee and permission
+         * checks are done once for the batch and a single aggregated fee is collected.
+         * @param fio_domain  the domain of every fio address in the batch
+         * @param fio_addresses  the fio addresses and their owner public keys, at most MAXREGADDRESSBATCH
+         * @param max_fee  the maximum fee the actor is willing to pay for the whole batch
+         * @param actor  the account paying for the registrations
+         * @param tpid  the tpid for the owner of the domain (this is optional)
+         */
+        [[eosio::action]]
+        void
+        regaddresses(const string &fio_domain, const vector<regaddressitem> &fio_addresses, const int64_t &max_fee,
+                     const name &actor, const string &tpid) {
+            require_auth(actor);
+
+            fio_400_assert(validateTPIDFormat(tpid), "tpid", tpid,
+                           "TPID must be empty or valid FIO address",
+                           ErrorPubKeyValid);
+            fio_400_assert(max_fee >= 0, "max_fee", to_string(max_fee), "Invalid fee value",
+                           ErrorMaxFeeInvalid);
+            fio_400_assert(fio_addresses.size() > 0 && fio_addresses.size() <= MAXREGADDRESSBATCH, "fio_addresses",
+                           "fio_addresses", "Min 1, Max 25 fio addresses are allowed",
+                           ErrorInvalidNumberAddresses);
+
+            FioAddress fd;
+            getFioAddressStruct(fio_domain, fd);
+            register_errors(fd, true);
+
+            const uint128_t domainHash = string_to_uint128_hash(fd.fiodomain.c_str());
+            auto domainsbyname = domains.get_index<"byname"_n>();
+            auto domains_iter = domainsbyname.find(domainHash);
+
+            fio_400_assert(domains_iter != domainsbyname.end(), "fio_domain", fio_domain,
+                           "FIO Domain not registered",
+                           ErrorDomainNotRegistered);
+
+            if (!domains_iter->is_public) {
+                fio_400_assert(domains_iter->account == actor.value, "fio_domain", fio_domain,
+                               "FIO Domain is not public. Only owner can create FIO Addresses.",
+                               ErrorInvalidFioNameFormat);
+            }
+
+            const uint32_t present_time = now();
+            fio_400_assert(present_time <= domains_iter->expiration, "fio_domain", fio_domain, "FIO Domain expired",
+                           ErrorDomainExpired);
+
+            auto fees_by_endpoint = fiofees.get_index<"byendpoint"_n>();
+            auto fee_iter = fees_by_endpoint.find(REGISTER_ADDRESS_ENDPOINT_HASH);
+            fio_400_assert(fee_iter != fees_by_endpoint.end(), "endpoint_name", REGISTER_ADDRESS_ENDPOINT,
+                           "FIO fee not found for endpoint", ErrorNoEndpoint);
+
+            const uint64_t fee_type = fee_iter->type;
+            fio_400_assert(fee_type == 0, "fee_type", to_string(fee_type),
+                           "unexpected fee type for endpoint register_fio_address, expected 0",
+                           ErrorNoEndpoint);
+
+            const uint64_t reg_amount = fee_iter->suf_amount * fio_addresses.size();
+            fio_400_assert(max_fee >= (int64_t)reg_amount, "max_fee", to_string(max_fee), "Fee exceeds supplied maximum.",
+                           ErrorMaxFeeExceeded);
+
+            const uint32_t expiration_time = get_now_plus_one_year();
+            const uint64_t bundleamount = getBundledAmount();
+            std::map<string, name> owners; //owner keys already resolved in this batch
+            auto namesbyname = fionames.get_index<"byname"_n>();
+
+            for (const auto &item : fio_addresses) {
+                FioAddress fa;
+                getFioAddressStruct(item.fio_address, fa);
+                register_errors(fa, false);
+                fio_400_assert(!fa.domainOnly && fa.fiodomain == fd.fiodomain, "fio_address", fa.fioaddress,
+                               "FIO address is not on the domain", ErrorInvalidFioNameFormat);
+
+                if (item.owner_fio_public_key.length() > 0) {
+                    fio_400_assert(isPubKeyValid(item.owner_fio_public_key), "owner_fio_public_key",
+                                   item.owner_fio_public_key, "Invalid FIO Public Key",
+                                   ErrorPubKeyValid);
+                }
+
+                name owner;
+                auto owner_iter = owners.find(item.owner_fio_public_key);
+                if (owner_iter != owners.end()) {
+                    owner = owner_iter->second;
+                } else {
+                    owner = accountmgnt(actor, item.owner_fio_public_key);
+                    owners[item.owner_fio_public_key] = owner;
+                }
+
+                const uint128_t nameHash = string_to_uint128_hash(fa.fioaddress.c_str());
+                fio_400_assert(namesbyname.find(nameHash) == namesbyname.end(), "fio_address", fa.fioaddress,
+                               "FIO address already registered", ErrorFioNameAlreadyRegistered);
+
+                auto key_iter = accountmap.find(owner.value);
+                fio_400_assert(key_iter != accountmap.end(), "owner", to_string(owner.value),
+                               "Owner is not bound in the account map.", ErrorActorNotInFioAccountMap);
+
+                const uint64_t id = fionames.available_primary_key();
+                fionames.emplace(actor, [&](struct fioname &a) {
+                    a.id = id;
+                    a.name = fa.fioaddress;
+                    a.namehash = nameHash;
+                    a.domain = fa.fiodomain;
+                    a.domainhash = domainHash;
+                    a.expiration = expiration_time;
+                    a.owner_account = owner.value;
+                    a.bundleeligiblecountdown = bundleamount;
+                    a.pub_address_count.emplace(1);
+                });
+                add_pub_address(nameHash, "FIO", "FIO", key_iter->clientkey, actor);
+            }
+
+            if (domains_iter->address_count.has_value()) {
+                domainsbyname.modify(domains_iter, _self, [&](struct domain &d) {
+                    d.address_count.emplace(d.address_count.value() + fio_addresses.size());
+                });
+            }
+
+            fio_fees(actor, asset(reg_amount, FIOSYMBOL), REGISTER_ADDRESS_ENDPOINT);
+            processbucketrewards(tpid, reg_amount, get_self(), actor);
+
+            if (REGADDRESSRAM > 0) {
+                action(
+                        permission_level{SYSTEMACCOUNT, "active"_n},
+                        "eosio"_n,
+                        "incram"_n,
+                        std::make_tuple(actor, REGADDRESSRAM * fio_addresses.size())
+                ).send();
+            }
+
+            struct tm timeinfo;
+            fioio::convertfiotime(expiration_time, &timeinfo);
+            std::string timebuffer = fioio::tmstringformat(timeinfo);
+
+            const string response_string = string("{\"status\": \"OK\",\"expiration\":\"") +
+                                           timebuffer + string("\",\"items_registered\":") +
+                                           to_string(fio_addresses.size()) + string(",\"fee_collected\":") +
+                                           to_string(reg_amount) + string("}");
+
+            fio_400_assert(transaction_size() <= MAX_TRX_SIZE, "transaction_size", std::to_string(transaction_size()),
+                           "Transaction is too large", ErrorTransactionTooLarge);
+
+            send_response(response_string.c_str());
+        }
+
         [[eosio::action]]
         void regdomain(const string &fio_domain, const string &owner_fio_public_key,
                   const int64_t &max_fee, const name &actor, const string &tpid) {
@@ -745,7 +960,7 @@ namespace fioio {
             fioio::convertfiotime(expiration_time, &timeinfo);
             std::string timebuffer = fioio::tmstringformat(timeinfo);
 
-            const uint128_t endpoint_hash = string_to_uint128_hash(REGISTER_DOMAIN_ENDPOINT);
+            const uint128_t endpoint_hash = REGISTER_DOMAIN_ENDPOINT_HASH;
 
             auto fees_by_endpoint = fiofees.get_index<"byendpoint"_n>();
             auto fee_iter = fees_by_endpoint.find(endpoint_hash);
@@ -818,7 +1033,7 @@ namespace fioio {
                            "FIO domain not found", ErrorDomainNotRegistered);
 
             const uint32_t expiration_time = domains_iter->expiration;
-            const uint128_t endpoint_hash = string_to_uint128_hash(RENEW_DOMAIN_ENDPOINT);
+            const uint128_t endpoint_hash = RENEW_DOMAIN_ENDPOINT_HASH;
 
             auto fees_by_endpoint = fiofees.get_index<"byendpoint"_n>();
             auto fee_iter = fees_by_endpoint.find(endpoint_hash);
@@ -869,6 +1084,143 @@ namespace fioio {
             send_response(response_string.c_str());
         }
 
+        /**********
+         * This action will renew a batch of fio addresses and fio domains, each expiration will be extended
+         * by one year from its previous value. Fees and rewards are processed once for the whole batch.
+         * @param fio_addresses  the fio addresses to be renewed
+         * @param fio_domains  the fio domains to be renewed
+         * @param max_fee  the maximum fee the user is willing to pay for the whole batch
+         * @param tpid  this is the owner of the domain
+         * @param actor  this is the account for the user requesting the renewals.
+         */
+        [[eosio::action]]
+        void
+        bulkrenew(const vector<string> &fio_addresses, const vector<string> &fio_domains, const int64_t &max_fee,
+                  const string &tpid, const name &actor) {
+            require_auth(actor);
+            fio_400_assert(validateTPIDFormat(tpid), "tpid", tpid,
+                           "TPID must be empty or valid FIO address",
+                           ErrorPubKeyValid);
+            fio_400_assert(max_fee >= 0, "max_fee", to_string(max_fee), "Invalid fee value",
+                           ErrorMaxFeeInvalid);
+
+            const uint64_t itemcount = fio_addresses.size() + fio_domains.size();
+            fio_400_assert(itemcount > 0 && itemcount <= MAXRENEWBATCH, "fio_addresses", "fio_addresses",
+                           "Min 1, Max 25 fio addresses and domains are allowed",
+                           ErrorInvalidNumberAddresses);
+
+            auto fees_by_endpoint = fiofees.get_index<"byendpoint"_n>();
+            uint64_t address_amount = 0;
+            uint64_t domain_amount = 0;
+
+            if (!fio_addresses.empty()) {
+                auto fee_iter = fees_by_endpoint.find(RENEW_ADDRESS_ENDPOINT_HASH);
+                fio_400_assert(fee_iter != fees_by_endpoint.end(), "endpoint_name", RENEW_ADDRESS_ENDPOINT,
+                               "FIO fee not found for endpoint", ErrorNoEndpoint);
+                fio_400_assert(fee_iter->type == 0, "fee_type", to_string(fee_iter->type),
+                               "unexpected fee type for endpoint renew_fio_address, expected 0",
+                               ErrorNoEndpoint);
+                address_amount = fee_iter->suf_amount * fio_addresses.size();
+            }
+            if (!fio_domains.empty()) {
+                auto fee_iter = fees_by_endpoint.find(RENEW_DOMAIN_ENDPOINT_HASH);
+                fio_400_assert(fee_iter != fees_by_endpoint.end(), "endpoint_name", RENEW_DOMAIN_ENDPOINT,
+                               "FIO fee not found for endpoint", ErrorNoEndpoint);
+                fio_400_assert(fee_iter->type == 0, "fee_type", to_string(fee_iter->type),
+                               "unexpected fee type for endpoint renew_fio_domain, expected 0",
+                               ErrorNoEndpoint);
+                domain_amount = fee_iter->suf_amount * fio_domains.size();
+            }
+
+            const uint64_t reg_amount = address_amount + domain_amount;
+            fio_400_assert(max_fee >= (int64_t)reg_amount, "max_fee", to_string(max_fee), "Fee exceeds supplied maximum.",
+                           ErrorMaxFeeExceeded);
+
+            const uint32_t present_time = now();
+            auto domainsbyname = domains.get_index<"byname"_n>();
+            auto namesbyname = fionames.get_index<"byname"_n>();
+
+            if (!fio_addresses.empty()) {
+                const uint64_t bundleamount = getBundledAmount();
+                std::map<uint128_t, uint32_t> domainexpirations; //domains already looked up in this batch
+
+                for (const auto &fio_address : fio_addresses) {
+                    FioAddress fa;
+                    getFioAddressStruct(fio_address, fa);
+                    register_errors(fa, false);
+                    fio_400_assert(!fa.domainOnly, "fio_address", fa.fioaddress, "Invalid FIO address",
+                                   ErrorInvalidFioNameFormat);
+
+                    const uint128_t domainHash = string_to_uint128_hash(fa.fiodomain.c_str());
+                    auto domainexp_iter = domainexpirations.find(domainHash);
+                    if (domainexp_iter == domainexpirations.end()) {
+                        auto domains_iter = domainsbyname.find(domainHash);
+                        fio_400_assert(domains_iter != domainsbyname.end(), "fio_address", fa.fioaddress,
+                                       "FIO Domain not registered",
+                                       ErrorDomainNotRegistered);
+                        domainexp_iter = domainexpirations.emplace(domainHash, domains_iter->expiration).first;
+                    }
+
+                    //add 30 days to the domain expiration, this call will work until 30 days past expire.
+                    fio_400_assert(present_time <= get_time_plus_seconds(domainexp_iter->second, SECONDS30DAYS),
+                                   "fio_address", fa.fioaddress, "FIO Domain expired",
+                                   ErrorDomainExpired);
+
+                    auto fioname_iter = namesbyname.find(string_to_uint128_hash(fa.fioaddress.c_str()));
+                    fio_400_assert(fioname_iter != namesbyname.end(), "fio_address", fa.fioaddress,
+                                   "FIO address not registered", ErrorFioNameNotRegistered);
+
+                    namesbyname.modify(fioname_iter, _self, [&](struct fioname &a) {
+                        a.expiration = get_time_plus_one_year(a.expiration);
+                        a.bundleeligiblecountdown = bundleamount + a.bundleeligiblecountdown;
+                    });
+                }
+            }
+
+            for (const auto &fio_domain : fio_domains) {
+                FioAddress fa;
+                getFioAddressStruct(fio_domain, fa);
+                register_errors(fa, true);
+                fio_400_assert(fa.domainOnly, "fio_domain", fa.fioaddress, "Invalid FIO domain",
+                               ErrorInvalidFioNameFormat);
+
+                auto domains_iter = domainsbyname.find(string_to_uint128_hash(fa.fiodomain.c_str()));
+                fio_400_assert(domains_iter != domainsbyname.end(), "fio_domain", fa.fioaddress,
+                               "FIO domain not found", ErrorDomainNotRegistered);
+
+                domainsbyname.modify(domains_iter, _self, [&](struct domain &a) {
+                    a.expiration = get_time_plus_one_year(a.expiration);
+                });
+            }
+
+            if (address_amount > 0) {
+                fio_fees(actor, asset(address_amount, FIOSYMBOL), RENEW_ADDRESS_ENDPOINT);
+            }
+            if (domain_amount > 0) {
+                fio_fees(actor, asset(domain_amount, FIOSYMBOL), RENEW_DOMAIN_ENDPOINT);
+            }
+            processbucketrewards(tpid, reg_amount, get_self(), actor);
+
+            const uint64_t ramamount = RENEWADDRESSRAM * fio_addresses.size() + RENEWDOMAINRAM * fio_domains.size();
+            if (ramamount > 0) {
+                action(
+                        permission_level{SYSTEMACCOUNT, "active"_n},
+                        "eosio"_n,
+                        "incram"_n,
+                        std::make_tuple(actor, ramamount)
+                ).send();
+            }
+
+            const string response_string = string("{\"status\": \"OK\",\"items_renewed\":") +
+                                           to_string(itemcount) + string(",\"fee_collected\":") +
+                                           to_string(reg_amount) + string("}");
+
+            fio_400_assert(transaction_size() <= MAX_TRX_SIZE, "transaction_size", std::to_string(transaction_size()),
+                           "Transaction is too large", ErrorTransactionTooLarge);
+
+            send_response(response_string.c_str());
+        }
+
         /**********
          * This action will renew a fio address, the expiration will be extended by one year from the
          * previous value of the expiration
@@ -919,7 +1271,7 @@ namespace fioio {
 
             const uint64_t expiration_time = fioname_iter->expiration;
             const uint64_t bundleeligiblecountdown = fioname_iter->bundleeligiblecountdown;
-            const uint128_t endpoint_hash = string_to_uint128_hash(RENEW_ADDRESS_ENDPOINT);
+            const uint128_t endpoint_hash = RENEW_ADDRESS_ENDPOINT_HASH;
 
             auto fees_by_endpoint = fiofees.get_index<"byendpoint"_n>();
             auto fee_iter = fees_by_endpoint.find(endpoint_hash);
@@ -991,9 +1343,11 @@ namespace fioio {
         void burnexpired() {
 
             std::vector<uint128_t> burnlist;
+            std::set<uint128_t> burnset; //the names already in burnlist
             std::vector<uint128_t> domainburnlist;
+            uint64_t burnrows = 0; //the fioname and pubaddrs rows of burnlist, counted against the batch size
 
-            const int numbertoburn = 100;
+            const uint64_t numbertoburn = burnConfig.get_or_default().batchsize;
             const int windowmaxyears = 20;
 
             const uint64_t nowtime = now();
@@ -1001,8 +1355,15 @@ namespace fioio {
             //this allows us to search through all of the domains.
             const uint32_t minexpiration = get_now_minus_years(windowmaxyears);
 
+            //resume the sweep where the previous call stopped, everything before the cursor has been burned.
+            burncursor cursor = burnCursor.get_or_default();
+
             auto domainexpidx = domains.get_index<"byexpiration"_n>();
-            auto domainiter = domainexpidx.lower_bound(minexpiration);
+            auto domainiter = domainexpidx.lower_bound(std::max(cursor.domainexpiration, (uint64_t) minexpiration));
+            while (domainiter != domainexpidx.end() && domainiter->expiration == cursor.domainexpiration &&
+                   domainiter->id < cursor.domainid) {
+                domainiter++;
+            }
 
             while (domainiter != domainexpidx.end()) {
                 const uint64_t expire = domainiter->expiration;
@@ -1012,48 +1373,79 @@ namespace fioio {
                     break;
                 } else {
                     const auto domainhash = domainiter->domainhash;
-                    auto fionamesbydomainhashidx = fionames.get_index<"bydomain"_n>();
-                    auto nmiter = fionamesbydomainhashidx.lower_bound(domainhash);
+                    const bool hascount = domainiter->address_count.has_value();
                     bool processed_all_in_domain = false;
 
-                    while (nmiter != fionamesbydomainhashidx.end()) {
-                        if (nmiter->domainhash == domainhash) {
-                            burnlist.push_back(nmiter->namehash);
-
-                            if (burnlist.size() >= numbertoburn) {
+                    if (hascount && domainiter->address_count.value() == 0) {
+                        processed_all_in_domain = true;
+                    } else {
+                        auto fionamesbydomainhashidx = fionames.get_index<"bydomain"_n>();
+                        auto nmiter = fionamesbydomainhashidx.lower_bound(domainhash);
+                        uint64_t collected = 0;
+
+                        while (nmiter != fionamesbydomainhashidx.end()) {
+                            if (nmiter->domainhash == domainhash) {
+                                burnlist.push_back(nmiter->namehash);
+                                burnset.insert(nmiter->namehash);
+                                burnrows += burn_rows(*nmiter);
+                                collected++;
+
+                                if (burnrows >= numbertoburn) {
+                                    break;
+                                }
+                                nmiter++;
+                            } else {
                                 break;
                             }
-                            nmiter++;
-                        } else {
+                        }
+                        if (hascount) {
+                            processed_all_in_domain = (collected >= domainiter->address_count.value());
+                        } else if (nmiter == fionamesbydomainhashidx.end() || nmiter->domainhash != domainhash) {
                             processed_all_in_domain = true;
-                            break;
+                        } else if (burnrows >= numbertoburn) {
+                            //the last name collected may have been the last one in the domain.
+                            nmiter++;
+                            processed_all_in_domain = (nmiter == fionamesbydomainhashidx.end() ||
+                                                       nmiter->domainhash != domainhash);
                         }
                     }
 
                     if (processed_all_in_domain) {
                         domainburnlist.push_back(domainnamehash);
+                        cursor.domainexpiration = expire;
+                        cursor.domainid = domainiter->id + 1;
+                    } else {
+                        cursor.domainexpiration = expire;
+                        cursor.domainid = domainiter->id;
                     }
-                    if (burnlist.size() >= numbertoburn) {
+                    if (burnrows >= numbertoburn) {
                         break;
                     }
                 }
                 domainiter++;
             }
 
-            if (burnlist.size() < numbertoburn) {
+            if (burnrows < numbertoburn) {
 
                 auto nameexpidx = fionames.get_index<"byexpiration"_n>();
-                auto nameiter = nameexpidx.lower_bound(minexpiration);
+                auto nameiter = nameexpidx.lower_bound(std::max(cursor.nameexpiration, (uint64_t) minexpiration));
+                while (nameiter != nameexpidx.end() && nameiter->expiration == cursor.nameexpiration &&
+                       nameiter->id < cursor.nameid) {
+                    nameiter++;
+                }
 
                 while (nameiter != nameexpidx.end()) {
                     const uint64_t expire = nameiter->expiration;
                     if ((expire + ADDRESSWAITFORBURNDAYS) > nowtime){
                         break;
                     } else {
-                        if (!(std::find(burnlist.begin(), burnlist.end(), nameiter->namehash) != burnlist.end())) {
+                        cursor.nameexpiration = expire;
+                        cursor.nameid = nameiter->id + 1;
+                        if (burnset.insert(nameiter->namehash).second) {
                             burnlist.push_back(nameiter->namehash);
+                            burnrows += burn_rows(*nameiter);
 
-                            if (burnlist.size() >= numbertoburn) {
+                            if (burnrows >= numbertoburn) {
                                 break;
                             }
                         }
@@ -1062,10 +1454,13 @@ namespace fioio {
                 }
             }
 
-            fio_400_assert(((burnlist.size() > 0) && (domainburnlist.size() >0)), "burnexpired", "burnexpired",
+            fio_400_assert(((burnlist.size() > 0) || (domainburnlist.size() > 0)), "burnexpired", "burnexpired",
                            "No work.", ErrorNoWork);
 
+            burnCursor.set(cursor, _self);
+
             //do the burning.
+            std::map<uint128_t, uint64_t> burnedperdomain;
             for (int i = 0; i < burnlist.size(); i++) {
                 const uint128_t burner = burnlist[i];
                 vector <uint64_t> ids;
@@ -1084,12 +1479,23 @@ namespace fioio {
                             std::make_tuple(burner)
                     ).send();
 
+                    burnedperdomain[fionamesiter->domainhash]++;
+                    erase_pub_addresses(burner, false);
                     namesbyname.erase(fionamesiter);
-                    tpidbyname.erase(tpiditer);
+                    if (tpiditer != tpidbyname.end()) {
+                        tpidbyname.erase(tpiditer);
+                    }
                 }
                 //remove from the
             }
 
+            //domains being burned are erased below, only update the count of the remaining ones.
+            for (const auto &burned : burnedperdomain) {
+                if (std::find(domainburnlist.begin(), domainburnlist.end(), burned.first) == domainburnlist.end()) {
+                    update_domain_address_count(burned.first, -(int64_t) burned.second);
+                }
+            }
+
             for (int i = 0; i < domainburnlist.size(); i++) {
                 const uint128_t burner = domainburnlist[i];
 
@@ -1110,6 +1516,112 @@ namespace fioio {
             send_response(response_string.c_str());
         }
 
+        /*******
+         * This action sets the number of items burnexpired will burn in each call.
+         * @param batch_size  the number of fio address and public address rows burned per call, between 1
+         *                    and MAXBURNBATCHSIZE
+         */
+        // @abi action
+        [[eosio::action]]
+        void setburnbatch(const uint64_t &batch_size) {
+            require_auth(_self);
+
+            fio_400_assert(batch_size > 0 && batch_size <= MAXBURNBATCHSIZE, "batch_size", to_string(batch_size),
+                           "Invalid batch size", ErrorInvalidValue);
+
+            burnConfig.set(burnconfig{batch_size}, _self);
+        }
+
+        /*******
+         * This action moves the public addresses of fio addresses registered before the pubaddrs table
+         * was introduced into the pubaddrs table. It resumes where the previous call stopped.
+         * @param amount  the number of fio addresses to process, at most 25 are processed per call
+         * @param actor  the block producer running the migration
+         */
+        // @abi action
+        [[eosio::action]]
+        void migraddrs(const uint16_t &amount, const name &actor) {
+            require_auth(actor);
+
+            auto prodbyowner = producers.get_index<"byowner"_n>();
+            auto proditer = prodbyowner.find(actor.value);
+
+            fio_400_assert(proditer != prodbyowner.end(), "actor", actor.to_string(),
+                           "Actor not active producer", ErrorNoFioAddressProducer);
+
+            const uint16_t limit = amount > 25 ? 25 : amount;
+            addrmigr migration = addrMigration.get_or_default();
+
+            uint16_t count = 0;
+            auto fioname_iter = fionames.lower_bound(migration.nextid);
+            while (fioname_iter != fionames.end() && count < limit) {
+                migrate_pub_addresses(fioname_iter->id, _self);
+                migration.nextid = fioname_iter->id + 1;
+                fioname_iter++;
+                count++;
+            }
+
+            fio_400_assert(count > 0, "migraddrs", "migraddrs", "No work.", ErrorNoWork);
+
+            addrMigration.set(migration, _self);
+
+            const string response_string = string("{\"status\": \"OK\",\"items_processed\":") +
+                                           to_string(count) + string("}");
+
+            send_response(response_string.c_str());
+        }
+
+        /*******
+         * This action sets the address_count of domains registered before the count was added,
+         * counting the fio addresses of each domain once. It resumes where the previous call stopped.
+         * @param amount  the number of domains to process, at most 25 are processed per call
+         * @param actor  the block producer running the migration
+         */
+        // @abi action
+        [[eosio::action]]
+        void migrdomcnt(const uint16_t &amount, const name &actor) {
+            require_auth(actor);
+
+            auto prodbyowner = producers.get_index<"byowner"_n>();
+            auto proditer = prodbyowner.find(actor.value);
+
+            fio_400_assert(proditer != prodbyowner.end(), "actor", actor.to_string(),
+                           "Actor not active producer", ErrorNoFioAddressProducer);
+
+            const uint16_t limit = amount > 25 ? 25 : amount;
+            domcntmigr migration = domcntMigration.get_or_default();
+
+            auto namesbydomain = fionames.get_index<"bydomain"_n>();
+            uint16_t count = 0;
+            auto domain_iter = domains.lower_bound(migration.nextid);
+            while (domain_iter != domains.end() && count < limit) {
+                if (!domain_iter->address_count.has_value()) {
+                    uint64_t addresses = 0;
+                    auto fioname_iter = namesbydomain.lower_bound(domain_iter->domainhash);
+                    const auto fioname_end = namesbydomain.upper_bound(domain_iter->domainhash);
+                    for (; fioname_iter != fioname_end; fioname_iter++) {
+                        addresses++;
+                    }
+
+                    domains.modify(domain_iter, _self, [&](struct domain &d) {
+                        d.address_count.emplace(addresses);
+                    });
+                }
+                migration.nextid = domain_iter->id + 1;
+                domain_iter++;
+                count++;
+            }
+
+            fio_400_assert(count > 0, "migrdomcnt", "migrdomcnt", "No work.", ErrorNoWork);
+
+            domcntMigration.set(migration, _self);
+
+            const string response_string = string("{\"status\": \"OK\",\"items_processed\":") +
+                                           to_string(count) + string("}");
+
+            send_response(response_string.c_str());
+        }
+
         /***
          * Given a fio user name, chain name and chain specific address will attach address to the user's FIO fioname.
          *
@@ -1389,7 +1901,7 @@ namespace fioio {
                            ErrorDomainExpired);
 
             fio_403_assert(fioname_iter->owner_account == actor.value, ErrorSignature);
-            const uint128_t endpoint_hash = string_to_uint128_hash(TRANSFER_ADDRESS_ENDPOINT);
+            const uint128_t endpoint_hash = TRANSFER_ADDRESS_ENDPOINT_HASH;
 
             //TEMP
             auto obtbyname = recordObtTable.get_index<"bypayee"_n>();
@@ -1432,17 +1944,15 @@ namespace fioio {
                                "FIO Address is proxy. Unregister first.", ErrorNoEndpoint);
             }
 
-            vector<tokenpubaddr> pubaddresses;
-            tokenpubaddr t1;
-            t1.public_address = new_owner_fio_public_key;
-            t1.token_code = "FIO";
-            t1.chain_code = "FIO";
-            pubaddresses.push_back(t1);
+            //the new owner starts with only the FIO public key mapped.
+            erase_pub_addresses(nameHash, false);
+            add_pub_address(nameHash, "FIO", "FIO", new_owner_fio_public_key, actor);
 
             //Transfer the address
             namesbyname.modify(fioname_iter, actor, [&](struct fioname &a) {
                 a.owner_account = nm.value;
-                a.addresses =  pubaddresses;
+                a.addresses.clear();
+                a.pub_address_count.emplace(1);
             });
 
             //fees
@@ -1524,12 +2034,15 @@ namespace fioio {
 
             //do the burn
             const uint64_t bundleeligiblecountdown = fioname_iter->bundleeligiblecountdown;
+            const uint128_t domainhash = fioname_iter->domainhash;
+            erase_pub_addresses(nameHash, false);
             namesbyname.erase(fioname_iter);
             if( tpid_iter != tpid_by_name.end() ){ tpid_by_name.erase(tpid_iter); }
+            update_domain_address_count(domainhash, -1);
 
             //fees
             uint64_t fee_amount = 0;
-            const uint128_t endpoint_hash = string_to_uint128_hash("burn_fio_address");
+            const uint128_t endpoint_hash = BURN_FIO_ADDRESS_ENDPOINT_HASH;
             auto fees_by_endpoint = fiofees.get_index<"byendpoint"_n>();
             auto fee_iter = fees_by_endpoint.find(endpoint_hash);
 
@@ -1589,7 +2102,7 @@ namespace fioio {
                            ErrorDomainExpired);
 
             fio_403_assert(domains_iter->account == actor.value, ErrorSignature);
-            const uint128_t endpoint_hash = string_to_uint128_hash(TRANSFER_DOMAIN_ENDPOINT);
+            const uint128_t endpoint_hash = TRANSFER_DOMAIN_ENDPOINT_HASH;
 
             auto fees_by_endpoint = fiofees.get_index<"byendpoint"_n>();
             auto fee_iter = fees_by_endpoint.find(endpoint_hash);
@@ -1674,7 +2187,7 @@ namespace fioio {
             fio_400_assert(present_time <= expiration, "fio_address", fa.fioaddress, "FIO Address expired.",
                            ErrorDomainExpired);
 
-            const uint128_t endpoint_hash = string_to_uint128_hash("add_bundled_transactions");
+            const uint128_t endpoint_hash = ADD_BUNDLED_TRANSACTION_ENDPOINT_HASH;
             auto fees_by_endpoint = fiofees.get_index<"byendpoint"_n>();
             auto fee_iter = fees_by_endpoint.find(endpoint_hash);
             fio_400_assert(fee_iter != fees_by_endpoint.end(), "endpoint_name", "add_bundled_transactions",
@@ -1734,6 +2247,6 @@ namespace fioio {
         }
     };
 
-    EOSIO_DISPATCH(FioNameLookup, (regaddress)(addaddress)(remaddress)(remalladdr)(regdomain)(renewdomain)(renewaddress)(setdomainpub)(burnexpired)(decrcounter)
+    EOSIO_DISPATCH(FioNameLookup, (regaddress)(regaddresses)(addaddress)(remaddress)(remalladdr)(regdomain)(renewdomain)(renewaddress)(bulkrenew)(setdomainpub)(burnexpired)(setburnbatch)(migraddrs)(migrdomcnt)(decrcounter)
     (bind2eosio)(burnaddress)(xferdomain)(xferaddress)(addbundles))
 }
@@ -10,6 +10,7 @@
 #include <eosiolib/eosio.hpp>
 #include <eosiolib/singleton.hpp>
 #include <eosiolib/asset.hpp>
+#include <eosiolib/crypto.hpp>
 #include <string>
 
 using std::string;
@@ -25,6 +26,13 @@ namespace fioio {
         EOSLIB_SERIALIZE( tokenpubaddr, (token_code)(chain_code)(public_address))
     };
 
+    // A fio address and its owner, as registered by regaddresses.
+    struct regaddressitem {
+        string fio_address;
+        string owner_fio_public_key;
+        EOSLIB_SERIALIZE( regaddressitem, (fio_address)(owner_fio_public_key))
+    };
+
     struct find_token {
         string token_code;
         find_token(string token_code) : token_code(token_code) {}
@@ -43,9 +51,10 @@ namespace fioio {
         uint128_t domainhash = 0;
         uint64_t expiration;
         uint64_t owner_account;
-        // Chain specific keys
+        // Chain specific keys, retired, the keys are in the pubaddrs table once pub_address_count is present.
         std::vector<tokenpubaddr> addresses;
         uint64_t bundleeligiblecountdown = 0;
+        eosio::binary_extension<uint64_t> pub_address_count; //number of rows in pubaddrs for this fio address
 
         // primary_key is required to store structure in multi_index table
         uint64_t primary_key() const { return id; }
@@ -55,7 +64,7 @@ namespace fioio {
         uint64_t by_owner() const { return owner_account; }
 
         EOSLIB_SERIALIZE(fioname, (id)(name)(namehash)(domain)(domainhash)(expiration)(owner_account)(addresses)(
-                bundleeligiblecountdown)
+                bundleeligiblecountdown)(pub_address_count)
         )
     };
 
@@ -68,6 +77,55 @@ namespace fioio {
     >
     fionames_table;
 
+    // Chain specific keys of a fio address, one row for each token code and chain code.
+    // @abi table pubaddrs i64
+    struct [[eosio::table]] pubaddress {
+        uint64_t id = 0;
+        uint128_t namehash = 0;
+        string token_code;
+        string chain_code;
+        string public_address;
+        checksum256 nametokenhash; //the namehash followed by the hash of token_code:chain_code
+
+        uint64_t primary_key() const { return id; }
+        checksum256 by_nametoken() const { return nametokenhash; }
+
+        EOSLIB_SERIALIZE(pubaddress, (id)(namehash)(token_code)(chain_code)(public_address)(nametokenhash)
+        )
+    };
+
+    typedef multi_index<"pubaddrs"_n, pubaddress,
+            indexed_by<"bynametoken"_n, const_mem_fun < pubaddress, checksum256, &pubaddress::by_nametoken>>
+    >
+    pubaddrs_table;
+
+    //the bynametoken key, the rows of a fio address are contiguous starting at pubaddress_key(namehash, 0).
+    inline checksum256 pubaddress_key(const uint128_t &namehash, const uint128_t &tokenhash) {
+        return checksum256(std::array<uint128_t, 2>{{namehash, tokenhash}});
+    }
+
+    // Progress of the migration of fioname addresses into the pubaddrs table.
+    // @abi table addrmigr i64
+    struct [[eosio::table]] addrmigr {
+        uint64_t nextid = 0;
+
+        EOSLIB_SERIALIZE(addrmigr, (nextid)
+        )
+    };
+
+    typedef singleton<"addrmigr"_n, addrmigr> addrmigr_singleton;
+
+    // Progress of the backfill of address_count on domains registered before the count was added.
+    // @abi table domcntmigr i64
+    struct [[eosio::table]] domcntmigr {
+        uint64_t nextid = 0;
+
+        EOSLIB_SERIALIZE(domcntmigr, (nextid)
+        )
+    };
+
+    typedef singleton<"domcntmigr"_n, domcntmigr> domcntmigr_singleton;
+
     struct [[eosio::action]] domain {
         uint64_t id;
         string name;
@@ -75,6 +133,7 @@ namespace fioio {
         uint64_t account;
         uint8_t is_public = 0;
         uint64_t expiration;
+        eosio::binary_extension<uint64_t> address_count; //number of fio addresses on the domain, absent on older rows
 
 
         uint64_t primary_key() const { return id; }
@@ -82,7 +141,7 @@ namespace fioio {
         uint64_t by_expiration() const { return expiration; }
         uint128_t by_name() const { return domainhash; }
 
-        EOSLIB_SERIALIZE(domain, (id)(name)(domainhash)(account)(is_public)(expiration)
+        EOSLIB_SERIALIZE(domain, (id)(name)(domainhash)(account)(is_public)(expiration)(address_count)
         )
     };
 
@@ -93,6 +152,32 @@ namespace fioio {
     >
     domains_table;
 
+    // Progress of the burnexpired sweep, the expiration and id of the next domain and of the next
+    // fio address to examine in the byexpiration indexes.
+    // @abi table burncursor i64
+    struct [[eosio::table]] burncursor {
+        uint64_t domainexpiration = 0;
+        uint64_t domainid = 0;
+        uint64_t nameexpiration = 0;
+        uint64_t nameid = 0;
+
+        EOSLIB_SERIALIZE(burncursor, (domainexpiration)(domainid)(nameexpiration)(nameid)
+        )
+    };
+
+    typedef singleton<"burncursor"_n, burncursor> burncursor_singleton;
+
+    // Number of items burnexpired burns per call, set by governance using setburnbatch.
+    // @abi table burnconfig i64
+    struct [[eosio::table]] burnconfig {
+        uint64_t batchsize = 100;
+
+        EOSLIB_SERIALIZE(burnconfig, (batchsize)
+        )
+    };
+
+    typedef singleton<"burnconfig"_n, burnconfig> burnconfig_singleton;
+
     // Maps client wallet generated public keys to EOS user account names.
     struct [[eosio::action]] eosio_name {
 
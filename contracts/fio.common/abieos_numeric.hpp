@@ -8,42 +8,14 @@
 #include <string>
 #include <string_view>
 #include <eosiolib/public_key.hpp>
+#include "keyops.hpp"
 
 namespace abieos {
 
-    const char base58_chars[] = "123456789ABCDEFGHJKLMNPQRSTUVWXYZabcdefghijkmnopqrstuvwxyz";
-
-    bool map_initialized = false;
-    std::array<int8_t, 256> base58_map{{0}};
-
-    auto get_base58_map() {
-        if (!map_initialized) {
-            for (unsigned i = 0; i < base58_map.size(); ++i)
-                base58_map[i] = -1;
-            for (unsigned i = 0; i < sizeof(base58_chars); ++i)
-                base58_map[base58_chars[i]] = i;
-            map_initialized = true;
-        }
-        return base58_map;
-    }
-
-
     template<size_t size>
     std::array<uint8_t, size> base58_to_binary(std::string_view s) {
-        std::array<uint8_t, size> result{{0}};
-        for (auto &src_digit : s) {
-            int carry = get_base58_map()[src_digit];
-            if (carry < 0)
-                eosio_assert(0, "invalid base-58 value");
-            for (auto &result_byte : result) {
-                int x = result_byte * 58 + carry;
-                result_byte = x;
-                carry = x >> 8;
-            }
-            if (carry)
-                eosio_assert(0, "base-58 value is out of range");
-        }
-        std::reverse(result.begin(), result.end());
+        std::array<uint8_t, size> result;
+        eosio_assert(fioio::base58_decode_fixed(s, result), "invalid base-58 value");
         return result;
     }
 
@@ -66,8 +38,13 @@ namespace abieos {
 
     eosio::public_key string_to_public_key(std::string_view s) {
         if (s.size() >= 3 && s.substr(0, 3) == "FIO") {
-            auto whole = base58_to_binary<37>(s.substr(3));
             eosio::public_key key{(uint8_t) key_type::k1};
+            const fioio::decoded_pubkey &decoded = fioio::decode_pubkey(s);
+            if (decoded.decoded) {
+                memcpy(key.data.data(), decoded.data.data(), key.data.size());
+                return key;
+            }
+            auto whole = base58_to_binary<37>(s.substr(3));
             static_assert(whole.size() == key.data.size() + 4, "Error: whole.size() != key.data.size() + 4");
             memcpy(key.data.data(), whole.data(), key.data.size());
             return key;
@@ -0,0 +1,104 @@
+/** Endpoint hash definitions file
+ *  Description: compile time sha1 used to produce the uint128_t end_point_hash of the fee endpoints,
+ *               so fee lookups by the byendpoint index do not hash the endpoint name at run time.
+ *  @author Adam Androulidakis, Casey Gardiner, Ed Rotthoff
+ *  @file endpoint_hash.hpp
+ *  @license FIO Foundation ( https://github.com/fioprotocol/fio/blob/master/LICENSE ) Dapix
+ *
+ *  Changes:
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+namespace fioio {
+
+    namespace ct_sha1 {
+
+        struct digest {
+            uint32_t h[5];
+        };
+
+        constexpr uint32_t rotl(const uint32_t value, const uint32_t bits) {
+            return (value << bits) | (value >> (32 - bits));
+        }
+
+        //returns byte idx of the sha1 padded message (message, 0x80, zeros, 64 bit big endian bit length).
+        constexpr uint8_t padded_byte(const char *str, const uint64_t len, const uint64_t paddedlen, const uint64_t idx) {
+            if (idx < len) return static_cast<uint8_t>(str[idx]);
+            if (idx == len) return 0x80;
+            if (idx >= paddedlen - 8) return static_cast<uint8_t>((len * 8) >> (8 * (paddedlen - 1 - idx)));
+            return 0;
+        }
+
+        constexpr digest hash(const char *str, const uint64_t len) {
+            digest d = {{0x67452301, 0xEFCDAB89, 0x98BADCFE, 0x10325476, 0xC3D2E1F0}};
+            const uint64_t paddedlen = ((len + 8) / 64 + 1) * 64;
+
+            for (uint64_t block = 0; block < paddedlen; block += 64) {
+                uint32_t w[80] = {};
+                for (int i = 0; i < 16; i++) {
+                    const uint64_t at = block + i * 4;
+                    w[i] = (uint32_t(padded_byte(str, len, paddedlen, at)) << 24) |
+                           (uint32_t(padded_byte(str, len, paddedlen, at + 1)) << 16) |
+                           (uint32_t(padded_byte(str, len, paddedlen, at + 2)) << 8) |
+                           uint32_t(padded_byte(str, len, paddedlen, at + 3));
+                }
+                for (int i = 16; i < 80; i++) {
+                    w[i] = rotl(w[i - 3] ^ w[i - 8] ^ w[i - 14] ^ w[i - 16], 1);
+                }
+
+                uint32_t a = d.h[0], b = d.h[1], c = d.h[2], e = d.h[4], dd = d.h[3];
+                for (int i = 0; i < 80; i++) {
+                    uint32_t f = 0, k = 0;
+                    if (i < 20) {
+                        f = (b & c) | (~b & dd);
+                        k = 0x5A827999;
+                    } else if (i < 40) {
+                        f = b ^ c ^ dd;
+                        k = 0x6ED9EBA1;
+                    } else if (i < 60) {
+                        f = (b & c) | (b & dd) | (c & dd);
+                        k = 0x8F1BBCDC;
+                    } else {
+                        f = b ^ c ^ dd;
+                        k = 0xCA62C1D6;
+                    }
+                    const uint32_t temp = rotl(a, 5) + f + e + k + w[i];
+                    e = dd;
+                    dd = c;
+                    c = rotl(b, 30);
+                    b = a;
+                    a = temp;
+                }
+                d.h[0] += a;
+                d.h[1] += b;
+                d.h[2] += c;
+                d.h[3] += dd;
+                d.h[4] += e;
+            }
+            return d;
+        }
+    }
+
+    /***
+     * compile time equivalent of string_to_uint128_hash. eosio::checksum160 packs the sha1 digest
+     * big endian into its uint128_t words, and string_to_uint128_hash copies the first word,
+     * so the result is the first 16 bytes of the digest read as a big endian number.
+     * @param str   the endpoint name, use a string literal (e.g. REGISTER_ADDRESS_ENDPOINT)
+     * @return the end_point_hash stored in the fiofees table for this endpoint.
+     */
+    template<size_t N>
+    constexpr uint128_t endpoint_hash(const char (&str)[N]) {
+        const ct_sha1::digest d = ct_sha1::hash(str, N - 1);
+        return (uint128_t(d.h[0]) << 96) | (uint128_t(d.h[1]) << 64) |
+               (uint128_t(d.h[2]) << 32) | uint128_t(d.h[3]);
+    }
+
+    //sha1("abc") = a9993e364706816aba3e25717850c26c9cd0d89d
+    static_assert(endpoint_hash("abc") ==
+                  ((uint128_t(0xa9993e364706816aULL) << 64) | uint128_t(0xba3e25717850c26cULL)),
+                  "compile time sha1 does not match the sha1 test vector");
+}
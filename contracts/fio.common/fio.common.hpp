@@ -10,6 +10,7 @@
 
 #include <vector>
 #include <string>
+#include <string_view>
 #include <eosiolib/eosio.hpp>
 #include <eosiolib/system.hpp>
 #include <eosiolib/singleton.hpp>
@@ -22,6 +23,7 @@
 #include "fio_common_validator.hpp"
 #include "chain_control.hpp"
 #include "account_operations.hpp"
+#include "endpoint_hash.hpp"
 
 #define YEARTOSECONDS 31536000
 #define SECONDS30DAYS 2592000
@@ -37,7 +39,14 @@
 #define YEARDAYS 365
 #define MAXBPS 42
 #define MAXACTIVEBPS 21
+#define MAXFEEVOTERBPS 150
 #define DEFAULTBUNDLEAMT 100
+#define MAXBURNBATCHSIZE 1000
+#define MAXREGADDRESSBATCH 25
+#define MAXRENEWBATCH 25
+#define MAXTRANSFERPAYEES 100
+#define MAXDIRTYVOTERS 50
+#define DIRTYVOTERSPERVOTE 3
 
 #define REGISTER_ADDRESS_ENDPOINT "register_fio_address"
 #define REGISTER_DOMAIN_ENDPOINT "register_fio_domain"
@@ -145,13 +154,13 @@ namespace fioio {
         return value;
     }
 
-    static uint128_t string_to_uint128_hash(const string str) {
+    static uint128_t string_to_uint128_hash(const std::string_view str) {
 
         eosio::checksum160 tmp;
         uint128_t retval = 0;
         uint8_t *bp = (uint8_t * ) & tmp;
 
-        tmp = eosio::sha1(str.c_str(), str.length());
+        tmp = eosio::sha1(str.data(), str.length());
 
         bp = (uint8_t * ) & tmp;
         memcpy(&retval, bp, sizeof(retval));
@@ -159,6 +168,38 @@ namespace fioio {
         return retval;
     }
 
+    //end_point_hash of each fee endpoint, these match string_to_uint128_hash of the endpoint name.
+    constexpr uint128_t REGISTER_ADDRESS_ENDPOINT_HASH = endpoint_hash(REGISTER_ADDRESS_ENDPOINT);
+    constexpr uint128_t REGISTER_DOMAIN_ENDPOINT_HASH = endpoint_hash(REGISTER_DOMAIN_ENDPOINT);
+    constexpr uint128_t RENEW_ADDRESS_ENDPOINT_HASH = endpoint_hash(RENEW_ADDRESS_ENDPOINT);
+    constexpr uint128_t RENEW_DOMAIN_ENDPOINT_HASH = endpoint_hash(RENEW_DOMAIN_ENDPOINT);
+    constexpr uint128_t TRANSFER_ADDRESS_ENDPOINT_HASH = endpoint_hash(TRANSFER_ADDRESS_ENDPOINT);
+    constexpr uint128_t TRANSFER_DOMAIN_ENDPOINT_HASH = endpoint_hash(TRANSFER_DOMAIN_ENDPOINT);
+    constexpr uint128_t REMOVE_ALL_PUB_ENDPOINT_HASH = endpoint_hash(REMOVE_ALL_PUB_ENDPOINT);
+    constexpr uint128_t REMOVE_PUB_ADDRESS_ENDPOINT_HASH = endpoint_hash(REMOVE_PUB_ADDRESS_ENDPOINT);
+    constexpr uint128_t REGISTER_PRODUCER_ENDPOINT_HASH = endpoint_hash(REGISTER_PRODUCER_ENDPOINT);
+    constexpr uint128_t ADD_PUB_ADDRESS_ENDPOINT_HASH = endpoint_hash(ADD_PUB_ADDRESS_ENDPOINT);
+    constexpr uint128_t UNREGISTER_PRODUCER_ENDPOINT_HASH = endpoint_hash(UNREGISTER_PRODUCER_ENDPOINT);
+    constexpr uint128_t VOTE_PRODUCER_ENDPOINT_HASH = endpoint_hash(VOTE_PRODUCER_ENDPOINT);
+    constexpr uint128_t VOTE_PROXY_ENDPOINT_HASH = endpoint_hash(VOTE_PROXY_ENDPOINT);
+    constexpr uint128_t UNREGISTER_PROXY_ENDPOINT_HASH = endpoint_hash(UNREGISTER_PROXY_ENDPOINT);
+    constexpr uint128_t REGISTER_PROXY_ENDPOINT_HASH = endpoint_hash(REGISTER_PROXY_ENDPOINT);
+    constexpr uint128_t TRANSFER_LOCKED_TOKENS_ENDPOINT_HASH = endpoint_hash(TRANSFER_LOCKED_TOKENS_ENDPOINT);
+    constexpr uint128_t TRANSFER_TOKENS_PUBKEY_ENDPOINT_HASH = endpoint_hash(TRANSFER_TOKENS_PUBKEY_ENDPOINT);
+    constexpr uint128_t CANCEL_FUNDS_REQUEST_ENDPOINT_HASH = endpoint_hash(CANCEL_FUNDS_REQUEST_ENDPOINT);
+    constexpr uint128_t REJECT_FUNDS_REQUEST_ENDPOINT_HASH = endpoint_hash(REJECT_FUNDS_REQUEST_ENDPOINT);
+    constexpr uint128_t NEW_FUNDS_REQUEST_ENDPOINT_HASH = endpoint_hash(NEW_FUNDS_REQUEST_ENDPOINT);
+    constexpr uint128_t RECORD_OBT_DATA_ENDPOINT_HASH = endpoint_hash(RECORD_OBT_DATA_ENDPOINT);
+    constexpr uint128_t SUBMIT_BUNDLED_TRANSACTION_ENDPOINT_HASH = endpoint_hash(SUBMIT_BUNDLED_TRANSACTION_ENDPOINT);
+    constexpr uint128_t SUBMIT_FEE_RATIOS_ENDPOINT_HASH = endpoint_hash(SUBMIT_FEE_RATIOS_ENDPOINT);
+    constexpr uint128_t SUBMIT_FEE_MULTIPLER_ENDPOINT_HASH = endpoint_hash(SUBMIT_FEE_MULTIPLER_ENDPOINT);
+    constexpr uint128_t BURN_FIO_ADDRESS_ENDPOINT_HASH = endpoint_hash(BURN_FIO_ADDRESS_ENDPOINT);
+    constexpr uint128_t ADD_BUNDLED_TRANSACTION_ENDPOINT_HASH = endpoint_hash(ADD_BUNDLED_TRANSACTION_ENDPOINT);
+
+    static_assert(REGISTER_ADDRESS_ENDPOINT_HASH ==
+                  ((uint128_t(0xbddf0a523d36abaaULL) << 64) | uint128_t(0x4c25424571095f1aULL)),
+                  "endpoint hash does not match string_to_uint128_hash(\"register_fio_address\")");
+
     //use this for debug to see the value of your uint128_t, this will match what shows in get table.
     static std::string to_hex(const char *d, uint32_t s) {
         std::string r;
@@ -235,64 +276,16 @@ namespace fioio {
 
     typedef singleton<"bounties"_n, bounty> bounties_table;
 
+    //Postcondition: fio.treasury has distributed the fee between the foundation, the tpid (and bounty) and the
+    // block producers, see FIOTreasury::feedistrib
     void process_rewards(const string &tpid, const uint64_t &amount, const name &auth, const name &actor) {
 
         action(
                 permission_level{auth, "active"_n},
                 TREASURYACCOUNT,
-                "fdtnrwdupdat"_n,
-                std::make_tuple((uint64_t)(static_cast<double>(amount) * .05))
+                "feedistrib"_n,
+                std::make_tuple(actor, amount, tpid)
         ).send();
-        fionames_table fionames(AddressContract, AddressContract.value);
-        uint128_t fioaddhash = string_to_uint128_hash(tpid.c_str());
-
-        auto namesbyname = fionames.get_index<"byname"_n>();
-        auto fionamefound = namesbyname.find(fioaddhash);
-
-        if (fionamefound != namesbyname.end()) {
-
-            bounties_table bounties(TPIDContract, TPIDContract.value);
-            uint64_t bamount = 0;
-
-            if (bounties.get().tokensminted < MAXBOUNTYTOKENSTOMINT) {
-                bamount = (uint64_t)(static_cast<double>(amount) * .40);
-
-                action(permission_level{TREASURYACCOUNT, "active"_n},
-                       TokenContract, "mintfio"_n,
-                       make_tuple(TREASURYACCOUNT, bamount)
-                ).send();
-
-                action(
-                        permission_level{TREASURYACCOUNT, "active"_n},
-                        TPIDContract,
-                        "updatebounty"_n,
-                        std::make_tuple(bamount)
-                ).send();
-
-            }
-
-            action(
-                    permission_level{auth, "active"_n},
-                    TPIDContract,
-                    "updatetpid"_n,
-                    std::make_tuple(tpid, actor, (amount / 10) + bamount)
-            ).send();
-
-            action(
-                    permission_level{auth, "active"_n},
-                    TREASURYACCOUNT,
-                    "bprewdupdate"_n,
-                    std::make_tuple((uint64_t)(static_cast<double>(amount) * .85))
-            ).send();
-
-        } else {
-            action(
-                    permission_level{auth, "active"_n},
-                    TREASURYACCOUNT,
-                    "bprewdupdate"_n,
-                    std::make_tuple((uint64_t)(static_cast<double>(amount) * .95))
-            ).send();
-        }
     }
 
 
@@ -365,40 +358,13 @@ namespace fioio {
         action(
                 permission_level{actor, "active"_n},
                 TREASURYACCOUNT,
-                "bprewdupdate"_n,
-                std::make_tuple((uint64_t)(static_cast<double>(amount) * .95))
-        ).send();
-
-        action(
-                permission_level{actor, "active"_n},
-                TREASURYACCOUNT,
-                "fdtnrwdupdat"_n,
-                std::make_tuple((uint64_t)(static_cast<double>(amount) * .05))
+                "feedistrib"_n,
+                std::make_tuple(actor, amount, string(""))
         ).send();
     }
 
     inline bool isPubKeyValid(const string &pubkey) {
-
-        if (pubkey.length() != 53) return false;
-
-        string pubkey_prefix("FIO");
-        auto result = mismatch(pubkey_prefix.begin(), pubkey_prefix.end(),
-                               pubkey.begin());
-        if (result.first != pubkey_prefix.end()) return false;
-        auto base58substr = pubkey.substr(pubkey_prefix.length());
-
-        vector<unsigned char> vch;
-        if (!decode_base58(base58substr, vch) || (vch.size() != 37)) return false;
-
-        array<unsigned char, 33> pubkey_data;
-        copy_n(vch.begin(), 33, pubkey_data.begin());
-
-        capi_checksum160 check_pubkey;
-        ripemd160(reinterpret_cast<char *>(pubkey_data.data()), 33, &check_pubkey);
-        if (memcmp(&check_pubkey.hash, &vch.end()[-4], 4) != 0) return false;
-        //end of the public key validity check.
-
-        return true;
+        return decode_pubkey(pubkey).valid;
     }
 
     static const uint64_t INITIALACCOUNTRAM  = 25600;
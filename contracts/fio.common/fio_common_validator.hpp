@@ -9,8 +9,7 @@
 #pragma once
 
 #include <string>
-
-#pragma once
+#include <string_view>
 
 namespace fioio {
 
@@ -36,8 +35,105 @@ namespace fioio {
         return temp;
     }
 
+    /**
+     * fioNameChar maps every byte to its lower case fio name character, '@' maps to itself,
+     * anything not allowed in a fio address maps to 0.
+     */
+    static const char fioNameChar[256] = {
+            0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+            0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+            0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, '-', 0, 0,
+            '0', '1', '2', '3', '4', '5', '6', '7', '8', '9', 0, 0, 0, 0, 0, 0,
+            '@', 'a', 'b', 'c', 'd', 'e', 'f', 'g', 'h', 'i', 'j', 'k', 'l', 'm', 'n', 'o',
+            'p', 'q', 'r', 's', 't', 'u', 'v', 'w', 'x', 'y', 'z', 0, 0, 0, 0, 0,
+            0, 'a', 'b', 'c', 'd', 'e', 'f', 'g', 'h', 'i', 'j', 'k', 'l', 'm', 'n', 'o',
+            'p', 'q', 'r', 's', 't', 'u', 'v', 'w', 'x', 'y', 'z', 0, 0, 0, 0, 0,
+            0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+            0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+            0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+            0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+            0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+            0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+            0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+            0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    };
+
+    /**
+     * FioAddressView holds the lower cased fio address in a fixed buffer,
+     * the name and domain are views into that buffer.
+     */
+    struct FioAddressView {
+        char buffer[maxFioLen];
+        uint8_t length = 0;
+        uint8_t atpos = 0;
+        bool domainOnly = true;
+
+        string_view fioaddress() const { return string_view(buffer, length); }
+
+        string_view fioname() const { return domainOnly ? string_view() : string_view(buffer, atpos); }
+
+        string_view fiodomain() const {
+            return domainOnly ? fioaddress() : string_view(buffer + atpos + 1, length - atpos - 1);
+        }
+    };
+
+    /**
+     * lower cases, splits and validates a fio address or fio domain in a single pass.
+     * @param p   the fio address (name@domain) or fio domain
+     * @param fa  receives the parsed address, only meaningful when true is returned
+     * @return true when p is a valid fio address or fio domain.
+     */
+    inline bool parseFioAddress(const string_view p, FioAddressView &fa) {
+        fa.length = 0;
+        fa.atpos = 0;
+        fa.domainOnly = true;
+
+        const size_t len = p.size();
+        if (len < 1 || len > maxFioLen) {
+            return false;
+        }
+
+        for (size_t i = 0; i < len; i++) {
+            const char c = fioNameChar[(uint8_t) p[i]];
+            if (c == 0) {
+                return false;
+            }
+            if (c == '@') {
+                //one @ per address, name and domain must not be empty or end with a hyphen.
+                if (!fa.domainOnly || i == 0 || fa.buffer[i - 1] == '-') {
+                    return false;
+                }
+                fa.domainOnly = false;
+                fa.atpos = i;
+            } else if (c == '-' && (i == 0 || fa.buffer[i - 1] == '@')) {
+                return false;
+            }
+            fa.buffer[i] = c;
+        }
+
+        const char last = fa.buffer[len - 1];
+        if (last == '-' || last == '@') {
+            return false;
+        }
+        if (fa.domainOnly ? len > maxFioDomainLen : len < 3) {
+            return false;
+        }
+
+        fa.length = len;
+        return true;
+    }
+
     inline void getFioAddressStruct(const string &p, FioAddress &fa) {
-        // Split the fio name and domain portions
+        FioAddressView view;
+        if (parseFioAddress(p, view)) {
+            fa.fioaddress.assign(view.fioaddress());
+            fa.fioname.assign(view.fioname());
+            fa.fiodomain.assign(view.fiodomain());
+            fa.domainOnly = view.domainOnly;
+            return;
+        }
+
+        // Not a valid fio address, keep the lower cased input so it can be reported
         fa.fioname = "";
         fa.fiodomain = "";
 
@@ -55,33 +151,23 @@ namespace fioio {
         }
     }
 
-    inline bool validateCharName(const string &name) {
-        if (name.find_first_not_of("abcdefghijklmnopqrstuvwxyz0123456789-") != std::string::npos) {
+    inline bool validateCharName(const string_view name) {
+        if (name.empty() || name.front() == '-' || name.back() == '-') {
             return false;
         }
-        if (name.front() == '-' || name.back() == '-') {
-            return false;
+        for (const char c : name) {
+            const char lc = fioNameChar[(uint8_t) c];
+            if (lc != c || c == '@') {
+                return false;
+            }
         }
 
         return true;
     }
 
     inline bool validateFioNameFormat(const FioAddress &fa) {
-        if (fa.domainOnly) {
-            if (fa.fiodomain.size() < 1 || fa.fiodomain.size() > maxFioDomainLen) {
-                return false;
-            }
-            return validateCharName(fa.fiodomain);
-        } else {
-            if (fa.fioaddress.size() < 3 || fa.fioaddress.size() > maxFioLen) {
-                return false;
-            }
-            if (!validateCharName(fa.fioname) || !validateCharName(fa.fiodomain)) {
-                return false;
-            };
-        }
-
-        return true;
+        FioAddressView view;
+        return parseFioAddress(fa.fioaddress, view);
     }
 
     inline bool validateChainNameFormat(const string &chain) {
@@ -105,9 +191,8 @@ namespace fioio {
 
     inline bool validateTPIDFormat(const string &tpid) {
         if (tpid.size() > 0) {
-            FioAddress fa;
-            getFioAddressStruct(tpid, fa);
-            return validateFioNameFormat(fa);
+            FioAddressView fa;
+            return parseFioAddress(tpid, fa);
         }
         return true;
     }
@@ -147,79 +232,4 @@ namespace fioio {
         return !s.empty() && std::find_if(s.begin(),
                                           s.end(), [](char c) { return !std::isdigit(c); }) == s.end();
     }
-
-    /** All alphanumeric characters except for "0", "I", "O", and "l" */
-    static const char *pszBase58 = "123456789ABCDEFGHJKLMNPQRSTUVWXYZabcdefghijkmnopqrstuvwxyz";
-    static const int8_t mapBase58[256] = {
-            -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
-            -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
-            -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
-            -1, 0, 1, 2, 3, 4, 5, 6, 7, 8, -1, -1, -1, -1, -1, -1,
-            -1, 9, 10, 11, 12, 13, 14, 15, 16, -1, 17, 18, 19, 20, 21, -1,
-            22, 23, 24, 25, 26, 27, 28, 29, 30, 31, 32, -1, -1, -1, -1, -1,
-            -1, 33, 34, 35, 36, 37, 38, 39, 40, 41, 42, 43, -1, 44, 45, 46,
-            47, 48, 49, 50, 51, 52, 53, 54, 55, 56, 57, -1, -1, -1, -1, -1,
-            -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
-            -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
-            -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
-            -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
-            -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
-            -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
-            -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
-            -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
-    };
-
-    bool DecodeBase58(const char *psz, std::vector<unsigned char> &vch) {
-        // Skip leading spaces.
-        while (*psz && isspace(*psz))
-            psz++;
-        // Skip and count leading '1's.
-        int zeroes = 0;
-        int length = 0;
-        while (*psz == '1') {
-            zeroes++;
-            psz++;
-        }
-        // Allocate enough space in big-endian base256 representation.
-        int size = strlen(psz) * 733 / 1000 + 1; // log(58) / log(256), rounded up.
-        std::vector<unsigned char> b256(size);
-        // Process the characters.
-        static_assert(sizeof(mapBase58) / sizeof(mapBase58[0]) == 256,
-                      "mapBase58.size() should be 256"); // guarantee not out of range
-        while (*psz && !isspace(*psz)) {
-            // Decode base58 character
-            int carry = mapBase58[(uint8_t) * psz];
-            if (carry == -1)  // Invalid b58 character
-                return false;
-            int i = 0;
-            for (std::vector<unsigned char>::reverse_iterator it = b256.rbegin();
-                 (carry != 0 || i < length) && (it != b256.rend()); ++it, ++i) {
-                carry += 58 * (*it);
-                *it = carry % 256;
-                carry /= 256;
-            }
-            assert(carry == 0);
-            length = i;
-            psz++;
-        }
-        // Skip trailing spaces.
-        while (isspace(*psz))
-            psz++;
-        if (*psz != 0)
-            return false;
-        // Skip leading zeroes in b256.
-        std::vector<unsigned char>::iterator it = b256.begin() + (size - length);
-        while (it != b256.end() && *it == 0)
-            it++;
-        // Copy result into output vector.
-        vch.reserve(zeroes + (b256.end() - it));
-        vch.assign(zeroes, 0x00);
-        while (it != b256.end())
-            vch.push_back(*(it++));
-        return true;
-    }
-
-    bool decode_base58(const string &str, vector<unsigned char> &vch) {
-        return DecodeBase58(str.c_str(), vch);
-    }
 }
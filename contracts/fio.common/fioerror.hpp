@@ -228,11 +228,22 @@ namespace fioio {
       throw  eosio::chain::eosio_assert_code_exception(code, "message", fioio::Code_404_Result(message).to_json().c_str()); \
    FC_MULTILINE_MACRO_END
 
+// The contract side assertions only build the JSON error message (and only evaluate the
+// field value arguments) when the test fails, the success path costs a single branch.
 #define fio_400_assert(test, fieldname, fieldvalue, fielderror, code) \
-   eosio_assert_message_code(test, fioio::Code_400_Result(fieldname, fieldvalue, fielderror).to_json().c_str(), code)
+   do { \
+      if( !(test) ) \
+         eosio_assert_message_code(false, fioio::Code_400_Result(fieldname, fieldvalue, fielderror).to_json().c_str(), code); \
+   } while(0)
 
 #define fio_403_assert(test, code) \
-   eosio_assert_message_code(test, fioio::Code_403_Result(code).to_json().c_str(), code)
+   do { \
+      if( !(test) ) \
+         eosio_assert_message_code(false, fioio::Code_403_Result(code).to_json().c_str(), code); \
+   } while(0)
 
 #define fio_404_assert(test, message, code) \
-   eosio_assert_message_code(test, fioio::Code_404_Result(message).to_json().c_str(), code)
+   do { \
+      if( !(test) ) \
+         eosio_assert_message_code(false, fioio::Code_404_Result(message).to_json().c_str(), code); \
+   } while(0)
@@ -12,6 +12,8 @@
 #pragma once
 
 #include <string>
+#include <string_view>
+#include <array>
 
 using namespace eosio;
 
@@ -19,9 +21,9 @@ namespace fioio {
 
     static uint32_t acctcap = 12;
 
-    const char *const ALPHABET =
-            "123456789ABCDEFGHJKLMNPQRSTUVWXYZabcdefghijkmnopqrstuvwxyz";
-    const char ALPHABET_MAP[128] = {
+    /** base58Map maps every byte to its base58 digit, -1 when it is not part of the
+     *  alphabet 123456789ABCDEFGHJKLMNPQRSTUVWXYZabcdefghijkmnopqrstuvwxyz */
+    static const int8_t base58Map[256] = {
             -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
             -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
             -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
@@ -29,17 +31,110 @@ namespace fioio {
             -1, 9, 10, 11, 12, 13, 14, 15, 16, -1, 17, 18, 19, 20, 21, -1,
             22, 23, 24, 25, 26, 27, 28, 29, 30, 31, 32, -1, -1, -1, -1, -1,
             -1, 33, 34, 35, 36, 37, 38, 39, 40, 41, 42, 43, -1, 44, 45, 46,
-            47, 48, 49, 50, 51, 52, 53, 54, 55, 56, 57, -1, -1, -1, -1, -1
+            47, 48, 49, 50, 51, 52, 53, 54, 55, 56, 57, -1, -1, -1, -1, -1,
+            -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+            -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+            -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+            -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+            -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+            -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+            -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+            -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    };
+
+    /***
+     * decodes str into the fixed size big endian buffer out, left padded with zeros.
+     * only the bytes already holding a value are touched for each digit.
+     * @return false on a character outside the base58 alphabet or when the value does not fit out.
+     */
+    template<size_t size>
+    inline bool base58_decode_fixed(const std::string_view str, std::array<unsigned char, size> &out) {
+        out.fill(0);
+        size_t used = 0; //count of low order bytes of out in use.
+        for (const char c : str) {
+            uint32_t carry = base58Map[(uint8_t) c];
+            if (carry > 57) return false;
+            size_t j = 0;
+            for (; j < used; j++) {
+                unsigned char &byte = out[size - 1 - j];
+                carry += uint32_t(byte) * 58;
+                byte = (unsigned char) (carry & 0xff);
+                carry >>= 8;
+            }
+            while (carry > 0) {
+                if (j == size) return false;
+                out[size - 1 - j] = (unsigned char) (carry & 0xff);
+                carry >>= 8;
+                j++;
+            }
+            used = j;
+        }
+        return true;
+    }
+
+    static const size_t FIOPUBKEYLEN = 53; //"FIO" + 50 base58 chars.
+    static const size_t FIOPUBKEYDATALEN = 37; //1 byte head, 256 bit key (32 bytes), 4 bytes checksum
+
+    struct decoded_pubkey {
+        char text[FIOPUBKEYLEN];
+        std::array<unsigned char, FIOPUBKEYDATALEN> data;
+        bool decoded = false; //the 50 chars after the 3 char prefix are the canonical base58 of a 37 byte value.
+        bool valid = false;   //decoded, the prefix is FIO and the ripemd160 checksum matches.
     };
 
-// result must be declared (for the worst case): char result[len * 2];
+    /***
+     * decodes a FIO public key once per action, the last few decoded keys are kept so the validation,
+     * account derivation and public_key construction done by one action share a single decode.
+     * @param pubkey  the FIO public key
+     * @return the decoded key, valid is false for anything that is not a FIO public key.
+     */
+    inline const decoded_pubkey &decode_pubkey(const std::string_view pubkey) {
+        static decoded_pubkey memo[4];
+        static uint8_t memoused = 0;
+        static uint8_t memonext = 0;
+        static decoded_pubkey scratch;
+
+        if (pubkey.size() != FIOPUBKEYLEN) {
+            scratch.decoded = false;
+            scratch.valid = false;
+            return scratch;
+        }
+        for (uint8_t i = 0; i < memoused; i++) {
+            if (memcmp(memo[i].text, pubkey.data(), FIOPUBKEYLEN) == 0) return memo[i];
+        }
+
+        decoded_pubkey &key = memo[memonext];
+        memonext = (memonext + 1) % 4;
+        if (memoused < 4) memoused++;
+
+        memcpy(key.text, pubkey.data(), FIOPUBKEYLEN);
+        key.decoded = base58_decode_fixed(pubkey.substr(3), key.data);
+        if (key.decoded) {
+            //base58 keeps leading zero bytes as leading '1's, one for one. with any other count the
+            //text is not the encoding of the 37 bytes, isPubKeyValid has always rejected those.
+            size_t ones = 3;
+            while (ones < FIOPUBKEYLEN && pubkey[ones] == '1') ones++;
+            size_t zeros = 0;
+            while (zeros < FIOPUBKEYDATALEN && key.data[zeros] == 0) zeros++;
+            key.decoded = ones - 3 == zeros;
+        }
+        key.valid = false;
+        if (key.decoded && memcmp(pubkey.data(), "FIO", 3) == 0) {
+            capi_checksum160 check_pubkey;
+            ripemd160(reinterpret_cast<const char *>(key.data.data()), 33, &check_pubkey);
+            key.valid = memcmp(&check_pubkey.hash, key.data.data() + 33, 4) == 0;
+        }
+        return key;
+    }
+
+    //fallback for keys that do not decode to 37 bytes, result must hold len * 2 bytes.
     static int DecodeBase58(
             const char *str, int len, unsigned char *result) {
         int resultlen = 1;
         if( str != nullptr ){
             result[0] = 0;
             for (int i = 0; i < len; i++) {
-                unsigned int carry = (unsigned int) ALPHABET_MAP[(unsigned char) str[i]];
+                unsigned int carry = (unsigned int) base58Map[(unsigned char) str[i]];
                 for (int j = 0; j < resultlen; j++) {
                     carry += (unsigned int) (result[j]) * 58;
                     result[j] = (unsigned char) (carry & 0xff);
@@ -89,17 +184,24 @@ namespace fioio {
     }
 
     inline void key_to_account(const std::string &pubkey, std::string &new_account) {
-        std::string pub_wif(pubkey);
-        pub_wif.erase(0, 3); // Remove 'FIO'/'EOS' prefix from wif
-        unsigned char *pub_key_bytes = new unsigned char[37]; // 1 byte head, 256 bit key (32 bytes), 4 bytes checksum (usually)
-        // extract key from wif -- note that if done within EOSIO, this process will be done anyways; just use the pre-decoded pubkey.
-        DecodeBase58(pub_wif.c_str(), pub_wif.length(), pub_key_bytes);
-        uint64_t res = shorten_key(pub_key_bytes);
+        uint64_t res;
+        const decoded_pubkey &key = decode_pubkey(pubkey);
+        //a decoded key is canonical, the variable length decode below gives the same 37 bytes for it.
+        if (key.decoded) {
+            std::array<unsigned char, FIOPUBKEYDATALEN> pub_key_bytes = key.data;
+            res = shorten_key(pub_key_bytes.data());
+        } else {
+            // extract key from wif, skipping the 'FIO'/'EOS' prefix.
+            const int wiflen = pubkey.length() > 3 ? pubkey.length() - 3 : 0;
+            unsigned char pub_key_bytes[2 * FIOPUBKEYLEN];
+            eosio_assert(wiflen <= FIOPUBKEYLEN, "invalid public key length");
+            DecodeBase58(pubkey.c_str() + pubkey.length() - wiflen, wiflen, pub_key_bytes);
+            res = shorten_key(pub_key_bytes);
+        }
         name tn = name{res};
         std::string myStr = tn.to_string();
         //throw an error for safety, since this code was just ported.
         new_account = myStr.substr(0, 12);
-        delete[] pub_key_bytes;
     }
 
     inline std::string key_to_account(const std::string &pubkey) {
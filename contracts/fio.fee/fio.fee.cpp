@@ -13,6 +13,7 @@
 #include <eosio/native/intrinsics.hpp>
 #include <string>
 #include <map>
+#include <algorithm>
 
 using std::string;
 
@@ -33,85 +34,302 @@ namespace fioio {
         feevoters_table feevoters;
         bundlevoters_table bundlevoters;
         feevotes2_table feevotes;
+        feevotes3_table feevotes3;
+        pendingfees_table pendingfees;
+        feemedians_table feemedians;
+        medianprods_table medianprods;
         eosiosystem::top_producers_table topprods;
+        eosiosystem::top_fee_voters_table topfeeprods;
         eosiosystem::producers_table prods;
 
-        vector<name> getTopProds(){
-            int NUMBER_TO_SELECT = 150;
+        //true if the actor is one of the top 150 producers that may vote for fees.
+        bool isTopFeeVoter(const name &actor) {
+            if (topfeeprods.begin() != topfeeprods.end()) {
+                return topfeeprods.find(actor.value) != topfeeprods.end();
+            }
+
+            //topfeeprods is filled by eosio once voting is activated, until then walk the producers.
             auto idx = prods.get_index<"prototalvote"_n>();
+            int count = 0;
+            for( auto it = idx.cbegin(); it != idx.cend() && count < MAXFEEVOTERBPS && 0 < it->total_votes && it->active(); ++it ) {
+                if (it->owner == actor) {
+                    return true;
+                }
+                count++;
+            }
+            return false;
+        }
 
-            std::vector< name > topprods;
-            topprods.reserve(NUMBER_TO_SELECT);
+        //queue the fee for computefees, callers set votes_pending on the fee.
+        void queue_pending_fee(const uint64_t &fee_id) {
+            if (pendingfees.find(fee_id) == pendingfees.end()) {
+                pendingfees.emplace(_self, [&](struct pendingfee &p) {
+                    p.fee_id = fee_id;
+                });
+            }
+        }
 
-            for( auto it = idx.cbegin(); it != idx.cend() && topprods.size() < NUMBER_TO_SELECT && 0 < it->total_votes && it->active(); ++it ) {
-                topprods.push_back(it->owner);
+        //converts feevotes2 votes, indexed by fee id with empty end_point for fees not voted,
+        //to the feevotes3 list of voted fees.
+        static vector<feevotevalue> compact_fee_votes(const vector<feevalue_ts> &votes) {
+            vector<feevotevalue> result;
+            for (uint64_t feeid = 0; feeid < votes.size(); feeid++) {
+                if (votes[feeid].end_point.length() > 0) {
+                    result.push_back(feevotevalue{feeid, votes[feeid].value, votes[feeid].timestamp});
+                }
             }
-            return topprods;
+            return result;
         }
 
-        uint32_t update_fees() {
-            vector<uint64_t> fee_ids; //hashes for endpoints to process.
+        //returns the vote of the list for the fee id, or votes.end() if the fee was not voted.
+        static vector<feevotevalue>::const_iterator find_fee_vote(const vector<feevotevalue> &votes,
+                                                                  const uint64_t &fee_id) {
+            auto vote = std::lower_bound(votes.begin(), votes.end(), fee_id,
+                                         [](const feevotevalue &v, const uint64_t &id) { return v.fee_id < id; });
+            return (vote != votes.end() && vote->fee_id == fee_id) ? vote : votes.end();
+        }
 
-            int NUMBER_FEES_TO_PROCESS = 10;
+        //returns the fee votes of the producer, or nullptr if it has not voted. votes of a producer
+        //still in feevotes2 are converted into legacyvotes.
+        const vector<feevotevalue> *get_fee_votes(const name &producer, vector<feevotevalue> &legacyvotes) {
+            auto votes_iter = feevotes3.find(producer.value);
+            if (votes_iter != feevotes3.end()) {
+                return &votes_iter->feevotes;
+            }
+            auto votesbybpname = feevotes.get_index<"bybpname"_n>();
+            auto legacy_iter = votesbybpname.find(producer.value);
+            if (legacy_iter == votesbybpname.end()) {
+                return nullptr;
+            }
+            legacyvotes = compact_fee_votes(legacy_iter->feevotes);
+            return &legacyvotes;
+        }
 
-            //get the fees needing processing.
-            auto fee = fiofees.begin();
-            while (fee != fiofees.end()) {
-                if(fee->votes_pending.value()){
-                    fee_ids.push_back(fee->fee_id);
-                    //only get the specified number of fees to process.
-                    if (fee_ids.size() == NUMBER_FEES_TO_PROCESS){
-                        break;
-                    }
+        static bool by_voted_fee(const producervote &lhs, const producervote &rhs) {
+            return (lhs.voted_fee < rhs.voted_fee) ||
+                   (lhs.voted_fee == rhs.voted_fee && lhs.block_producer_name < rhs.block_producer_name);
+        }
+
+        //returns the median of votes sorted by voted_fee, or -1 when there are too few votes.
+        int64_t median_of(const vector<producervote> &votes) {
+            int64_t median_fee = -1;
+            if (votes.size() >= MIN_FEE_VOTERS_FOR_MEDIAN) {
+                const int size = votes.size();
+                if (size % 2 == 0) {
+                    median_fee = (votes[size / 2 - 1].voted_fee + votes[size / 2].voted_fee) / 2;
+                } else {
+                    median_fee = votes[size / 2].voted_fee;
                 }
-                fee++;
             }
+            return median_fee;
+        }
 
-            //throw a 400 error if fees to process is empty.
-            fio_400_assert(fee_ids.size() > 0, "compute fees", "compute fees",
-                           "No Work.", ErrorNoWork);
+        //stores the sorted votes of the fee and returns their median.
+        int64_t save_fee_votes(const uint64_t &fee_id, const vector<producervote> &votes) {
+            auto median_iter = feemedians.find(fee_id);
+            if (median_iter == feemedians.end()) {
+                if (votes.size() > 0) {
+                    feemedians.emplace(_self, [&](struct feemedian &m) {
+                        m.fee_id = fee_id;
+                        m.votes = votes;
+                    });
+                }
+            } else if (votes.size() > 0) {
+                feemedians.modify(median_iter, _self, [&](struct feemedian &m) {
+                    m.votes = votes;
+                });
+            } else {
+                feemedians.erase(median_iter);
+            }
+            return median_of(votes);
+        }
 
-            vector<uint64_t> votesufs;
-            int processed_fees = 0;
+        /**
+         * removes the votes of the removed producers from the fee, sets the added votes and updates
+         * the fee to the new median. the fee must not be in feespending.
+         * @param fee_id the fee voted
+         * @param removed the producers whose votes are removed
+         * @param added the votes of top producers, times their multiplier, replacing any vote they had
+         */
+        void update_fee_votes(const uint64_t &fee_id, const vector<name> &removed, const vector<producervote> &added) {
+            auto fee_iter = fiofees.find(fee_id);
+            if (fee_iter == fiofees.end()) {
+                return;
+            }
 
-            for(int i=0;i<fee_ids.size();i++) { //for each fee to process
-                votesufs.clear();
-                auto topprod = topprods.begin();
-                while (topprod != topprods.end()) { //get the votes of the producers, compute the voted fee, and median.
-                    //get the fee voters record of this BP.
+            vector<producervote> votes;
+            auto median_iter = feemedians.find(fee_id);
+            if (median_iter != feemedians.end()) {
+                votes = median_iter->votes;
+            }
+
+            votes.erase(std::remove_if(votes.begin(), votes.end(), [&](const producervote &v) {
+                return std::find(removed.begin(), removed.end(), v.block_producer_name) != removed.end() ||
+                       std::find_if(added.begin(), added.end(), [&](const producervote &a) {
+                           return a.block_producer_name == v.block_producer_name;
+                       }) != added.end();
+            }), votes.end());
+            for (const auto &new_vote : added) {
+                votes.insert(std::lower_bound(votes.begin(), votes.end(), new_vote, by_voted_fee), new_vote);
+            }
+
+            const int64_t median_fee = save_fee_votes(fee_id, votes);
+            if (median_fee > 0) {
+                fiofees.modify(fee_iter, _self, [&](struct fiofee &ff) {
+                    ff.suf_amount = median_fee;
+                });
+            }
+        }
+
+        /**
+         * sets the vote of a top producer on the fee and updates the fee to the new median.
+         * the fee must not be in feespending.
+         * @param fee_id the fee voted
+         * @param producer the top producer voting
+         * @param voted_fee the vote of the producer times its multiplier
+         */
+        void update_fee_median(const uint64_t &fee_id, const name &producer, const uint64_t &voted_fee) {
+            update_fee_votes(fee_id, {}, {producervote{producer, voted_fee}});
+        }
+
+        //the votes to take out of and put into the feemedians votes of one fee.
+        struct median_change {
+            vector<name> removed;
+            vector<producervote> added;
+        };
+
+        /**
+         * the feemedians votes are only valid for the top producers they were built from, kept in medianprods.
+         * when eosio changed topprods since then, the votes of the producers that left are removed from the
+         * fees they voted and the multiplied votes of the producers that joined are added, other fees are
+         * not touched. fees in feespending are always rebuilt before their votes are used, the others are
+         * kept current here and by setfeevote and setfeemult.
+         * @return the number of producers that left or joined plus the number of fees updated, 0 when
+         * topprods did not change since the last sync.
+         */
+        uint32_t sync_fee_medians() {
+            eosiosystem::top_producers_state_singleton topprodstate(SYSTEMACCOUNT, SYSTEMACCOUNT.value);
+            const uint64_t version = topprodstate.get_or_default().version;
+
+            medianstate_singleton medianstates(_self, _self.value);
+            if (medianstates.exists() && medianstates.get().topprodsversion == version) {
+                return 0;
+            }
+
+            //both tables are keyed by producer, walk them together. before the first sync medianprods
+            //is empty and every top producer joins.
+            std::map<uint64_t, median_change> changes;
+            vector<name> joined;
+            uint32_t work = 0;
+            vector<feevotevalue> legacyvotes;
+            auto medianprod_iter = medianprods.begin();
+            auto topprod = topprods.begin();
+            while (medianprod_iter != medianprods.end() || topprod != topprods.end()) {
+                if (topprod == topprods.end() ||
+                    (medianprod_iter != medianprods.end() && medianprod_iter->producer < topprod->producer)) {
+                    //this producer left the top producers.
+                    const vector<feevotevalue> *bpvotes = get_fee_votes(medianprod_iter->producer, legacyvotes);
+                    if (bpvotes != nullptr) {
+                        for (const auto &vote : *bpvotes) {
+                            changes[vote.fee_id].removed.push_back(medianprod_iter->producer);
+                        }
+                    }
+                    medianprod_iter = medianprods.erase(medianprod_iter);
+                    work++;
+                } else if (medianprod_iter == medianprods.end() || topprod->producer < medianprod_iter->producer) {
+                    //this producer joined the top producers, its votes count once it has a multiplier.
                     auto voters_iter = feevoters.find(topprod->producer.value);
-                    //if there is no fee voters record, then there is not a multiplier, skip this BP.
-                    if (voters_iter != feevoters.end()) {
-                        //get all the fee votes made by this BP.
-                        auto votesbybpname = feevotes.get_index<"bybpname"_n>();
-                        auto bpvote_iter = votesbybpname.find(topprod->producer.value);
-                        int countem = 0;
-
-                        if (bpvote_iter != votesbybpname.end()) {
-                            //if its in the votes list, and if it has a vote, IE end_point is greater 0, then use if.
-                            if ((bpvote_iter->feevotes.size() > fee_ids[i]) &&
-                                (bpvote_iter->feevotes[fee_ids[i]].end_point.length() > 0)) {
-                                const double dresult = voters_iter->fee_multiplier *
-                                                       (double) bpvote_iter->feevotes[fee_ids[i]].value;
-                                const uint64_t voted_fee = (uint64_t)(dresult);
-                                votesufs.push_back(voted_fee);
-                            }
+                    const vector<feevotevalue> *bpvotes = get_fee_votes(topprod->producer, legacyvotes);
+                    if (voters_iter != feevoters.end() && bpvotes != nullptr) {
+                        for (const auto &vote : *bpvotes) {
+                            const double dresult = voters_iter->fee_multiplier * (double) vote.value;
+                            changes[vote.fee_id].added.push_back(producervote{topprod->producer, (uint64_t)(dresult)});
                         }
                     }
+                    joined.push_back(topprod->producer);
+                    topprod++;
+                } else {
+                    medianprod_iter++;
                     topprod++;
                 }
+            }
+
+            for (const auto &producer : joined) {
+                medianprods.emplace(_self, [&](struct medianprod &m) {
+                    m.producer = producer;
+                });
+                work++;
+            }
 
-                //compute the median from the votesufs.
-                int64_t median_fee = -1;
-                if (votesufs.size() >= MIN_FEE_VOTERS_FOR_MEDIAN) {
-                    sort(votesufs.begin(), votesufs.end());
-                    int size = votesufs.size();
-                    if (votesufs.size() % 2 == 0) {
-                        median_fee = (votesufs[size / 2 - 1] + votesufs[size / 2]) / 2;
-                    } else {
-                        median_fee = votesufs[size / 2];
+            for (const auto &change : changes) {
+                if (pendingfees.find(change.first) == pendingfees.end()) {
+                    update_fee_votes(change.first, change.second.removed, change.second.added);
+                    work++;
+                }
+            }
+            medianstates.set(medianstate{version}, _self);
+            return work;
+        }
+
+        uint32_t update_fees() {
+            vector<uint64_t> fee_ids; //hashes for endpoints to process.
+
+            int NUMBER_FEES_TO_PROCESS = 10;
+
+            //a change of top producers is work of its own, a call with no pending fees still applies it.
+            const uint32_t synced = sync_fee_medians();
+
+            //get the fees needing processing, they are taken off the queue here and
+            //their votes_pending flag is cleared below.
+            auto pending = pendingfees.begin();
+            while (pending != pendingfees.end() && fee_ids.size() < NUMBER_FEES_TO_PROCESS) {
+                fee_ids.push_back(pending->fee_id);
+                pending = pendingfees.erase(pending);
+            }
+
+            //throw a 400 error if there is nothing to sync and fees to process is empty.
+            fio_400_assert(fee_ids.size() > 0 || synced > 0, "compute fees", "compute fees",
+                           "No Work.", ErrorNoWork);
+            if (fee_ids.size() == 0) {
+                return synced;
+            }
+
+            //the voted fees of the top producers, one vector per fee to process. each producer's
+            //multiplier and votes are read once and used for all the fees.
+            vector<vector<producervote>> feevotesufs(fee_ids.size());
+            vector<feevotevalue> legacyvotes;
+            auto topprod = topprods.begin();
+            while (topprod != topprods.end()) {
+                //get the fee voters record of this BP.
+                auto voters_iter = feevoters.find(topprod->producer.value);
+                //if there is no fee voters record, then there is not a multiplier, skip this BP.
+                if (voters_iter != feevoters.end()) {
+                    //get all the fee votes made by this BP.
+                    const vector<feevotevalue> *bpvotes = get_fee_votes(topprod->producer, legacyvotes);
+
+                    if (bpvotes != nullptr) {
+                        for (int i = 0; i < fee_ids.size(); i++) {
+                            //if the BP voted for this fee, then use it.
+                            auto vote = find_fee_vote(*bpvotes, fee_ids[i]);
+                            if (vote != bpvotes->end()) {
+                                const double dresult = voters_iter->fee_multiplier * (double) vote->value;
+                                const uint64_t voted_fee = (uint64_t)(dresult);
+                                feevotesufs[i].push_back(producervote{topprod->producer, voted_fee});
+                            }
+                        }
                     }
                 }
+                topprod++;
+            }
+
+            int processed_fees = 0;
+
+            for(int i=0;i<fee_ids.size();i++) { //for each fee to process
+                vector<producervote> &votesufs = feevotesufs[i];
+
+                //compute the median from the votesufs, and keep them for the votes to come.
+                sort(votesufs.begin(), votesufs.end(), by_voted_fee);
+                const int64_t median_fee = save_fee_votes(fee_ids[i], votesufs);
 
                 //set median as the new fee amount.
 
@@ -135,7 +353,7 @@ namespace fioio {
             fio_400_assert(transaction_size() <= MAX_TRX_SIZE, "transaction_size", std::to_string(transaction_size()),
               "Transaction is too large", ErrorTransactionTooLarge);
 
-            return processed_fees;
+            return processed_fees + synced;
         }
 
     public:
@@ -147,7 +365,12 @@ namespace fioio {
                   bundlevoters(_self, _self.value),
                   feevoters(_self, _self.value),
                   feevotes(_self, _self.value),
+                  feevotes3(_self, _self.value),
+                  pendingfees(_self, _self.value),
+                  feemedians(_self, _self.value),
+                  medianprods(_self, _self.value),
                   topprods(SYSTEMACCOUNT, SYSTEMACCOUNT.value),
+                  topfeeprods(SYSTEMACCOUNT, SYSTEMACCOUNT.value),
                   prods(SYSTEMACCOUNT,SYSTEMACCOUNT.value){
         }
 
@@ -166,31 +389,41 @@ namespace fioio {
             require_auth(actor);
             bool dbgout = false;
 
-            //check that the actor is in the top42.
-            vector<name> top_prods = getTopProds();
-
-            fio_400_assert((std::find(top_prods.begin(), top_prods.end(), actor)) !=
-                top_prods.end(), "actor", actor.to_string()," Not a top 150 BP",ErrorFioNameNotReg);
+            //check that the actor is in the top150.
+            fio_400_assert(isTopFeeVoter(actor), "actor", actor.to_string()," Not a top 150 BP",ErrorFioNameNotReg);
 
             fio_400_assert(max_fee >= 0, "max_fee", to_string(max_fee), "Invalid fee value",
                            ErrorMaxFeeInvalid);
             const uint32_t nowtime = now();
 
+            //the medians are synced for every voter before its votes are read, so votes made outside
+            //the top producers are picked up when the producer joins them.
+            sync_fee_medians();
+
             //get all the votes made by this actor. go through the list
             //and find the fee vote to update.
-            auto feevotesbybpname = feevotes.get_index<"bybpname"_n>();
-            // auto votebyname_iter = feevotesbybpname.lower_bound(actor.value);
-            auto votebyname_iter = feevotesbybpname.find(actor.value);
+            auto votebyname_iter = feevotes3.find(actor.value);
 
-            vector<feevalue_ts> feevotesv;
+            vector<feevotevalue> feevotesv;
             bool emplacerec = true;
 
-            //check for time violation.
-            if (votebyname_iter != feevotesbybpname.end()){
+            if (votebyname_iter != feevotes3.end()){
                 emplacerec = false;
                 feevotesv = votebyname_iter->feevotes;
+            } else {
+                //move the votes of this actor out of feevotes2.
+                auto feevotesbybpname = feevotes.get_index<"bybpname"_n>();
+                auto legacy_iter = feevotesbybpname.find(actor.value);
+                if (legacy_iter != feevotesbybpname.end()) {
+                    feevotesv = compact_fee_votes(legacy_iter->feevotes);
+                    feevotesbybpname.erase(legacy_iter);
+                }
             }
 
+            //a vote of a top producer with a multiplier updates the fee median right away.
+            const bool istopprod = topprods.find(actor.value) != topprods.end();
+            auto voters_iter = feevoters.find(actor.value);
+
             // go through all the fee values passed in.
             for (auto &feeval : fee_values) {
                 //check the endpoint exists for this fee
@@ -207,49 +440,41 @@ namespace fioio {
 
                 uint64_t feeid = fees_iter->fee_id;
 
-                // if the vector doesnt have an entry at this fees id index, add items out to this index.
-                // items with an empty string for end_point will NOT be used in median calcs.
-                if (feevotesv.size() < (feeid+1)){
-                    for(int ix = feevotesv.size();ix<=(feeid+1);ix++)
-                    {
-                        feevalue_ts tfv;
-                        feevotesv.push_back(tfv);
-                    }
+                //find the vote for this fee, or insert it keeping the votes sorted by fee id.
+                auto vote = std::lower_bound(feevotesv.begin(), feevotesv.end(), feeid,
+                                             [](const feevotevalue &v, const uint64_t &id) { return v.fee_id < id; });
+                if (vote == feevotesv.end() || vote->fee_id != feeid) {
+                    vote = feevotesv.insert(vote, feevotevalue{feeid, -1, 0});
                 }
 
-                uint64_t idtoremove;
-                bool found = false;
-
-                fio_400_assert(!(feevotesv[feeid].timestamp > (nowtime - TIME_BETWEEN_FEE_VOTES_SECONDS)), "", "", "Too soon since last call", ErrorTimeViolation);
+                fio_400_assert(!(vote->timestamp > (nowtime - TIME_BETWEEN_FEE_VOTES_SECONDS)), "", "", "Too soon since last call", ErrorTimeViolation);
 
-                feevotesv[feeid].end_point = feeval.end_point;
-                feevotesv[feeid].value = feeval.value;
-                feevotesv[feeid].timestamp = (uint64_t)nowtime;
+                vote->value = feeval.value;
+                vote->timestamp = (uint64_t)nowtime;
 
-                if(topprods.find(actor.value) != topprods.end()) {
-                    feesbyendpoint.modify(fees_iter, _self, [&](struct fiofee &a) {
-                        a.votes_pending.emplace(true);
-                    });
+                //fees in feespending get the vote when computefees rebuilds them.
+                if (istopprod && voters_iter != feevoters.end() && pendingfees.find(feeid) == pendingfees.end()) {
+                    const double dresult = voters_iter->fee_multiplier * (double) feeval.value;
+                    update_fee_median(feeid, actor, (uint64_t)(dresult));
                 }
             }
 
             //emplace or update.
             if (emplacerec){
-                feevotes.emplace(actor, [&](struct feevote2 &fv) {
-                    fv.id = feevotes.available_primary_key();
+                feevotes3.emplace(actor, [&](struct feevote3 &fv) {
                     fv.block_producer_name = actor;
                     fv.feevotes = feevotesv;
                     fv.lastvotetimestamp = nowtime;
                 });
             } else {
-                feevotesbybpname.modify(votebyname_iter, actor, [&](struct feevote2 &fv) {
+                feevotes3.modify(votebyname_iter, actor, [&](struct feevote3 &fv) {
                     fv.feevotes = feevotesv;
                     fv.lastvotetimestamp = nowtime;
                 });
             }
 
             //begin new fees, logic for Mandatory fees.
-            uint128_t endpoint_hash = string_to_uint128_hash(SUBMIT_FEE_RATIOS_ENDPOINT);
+            uint128_t endpoint_hash = SUBMIT_FEE_RATIOS_ENDPOINT_HASH;
 
             auto fees_by_endpoint = fiofees.get_index<"byendpoint"_n>();
             auto fee_iter = fees_by_endpoint.find(endpoint_hash);
@@ -293,6 +518,8 @@ namespace fioio {
 
         /**********
       * This method will update the fees based upon the present votes made by producers.
+      * it also moves the fee medians to a new set of top producers, fees_processed counts the
+      * producer and fee changes of that sync too, it fails with No Work only when both are empty.
       */
         [[eosio::action]]
         void computefees() {
@@ -302,6 +529,46 @@ namespace fioio {
             send_response(response_string.c_str());
         }
 
+        /**********
+         * This action moves up to amount producer fee votes from feevotes2 to feevotes3.
+         * the migrated rows are paid by this contract, the RAM of the feevotes2 rows goes back to the producers.
+         * @param amount the number of feevotes2 rows to move, 1 to 100.
+         */
+        [[eosio::action]]
+        void migrfeevote(const uint16_t &amount) {
+            require_auth(_self);
+            check(amount > 0 && amount <= 100, "amount must be between 1 and 100");
+
+            uint16_t count = 0;
+            auto legacy_iter = feevotes.begin();
+            while (legacy_iter != feevotes.end() && count < amount) {
+                if (feevotes3.find(legacy_iter->block_producer_name.value) == feevotes3.end()) {
+                    feevotes3.emplace(_self, [&](struct feevote3 &fv) {
+                        fv.block_producer_name = legacy_iter->block_producer_name;
+                        fv.feevotes = compact_fee_votes(legacy_iter->feevotes);
+                        fv.lastvotetimestamp = legacy_iter->lastvotetimestamp;
+                    });
+                }
+                legacy_iter = feevotes.erase(legacy_iter);
+                count++;
+            }
+        }
+
+        /**********
+         * This action queues the fees that had votes_pending set before the feespending table existed,
+         * it only needs to run once after the contract is updated.
+         */
+        [[eosio::action]]
+        void migrpending() {
+            require_auth(_self);
+
+            for (const auto &fee : fiofees) {
+                if (fee.votes_pending.value()) {
+                    queue_pending_fee(fee.fee_id);
+                }
+            }
+        }
+
        /********
         * This action allows block producers to vote for the number of transactions that will be permitted
         * for free in the FIO bundled transaction model.
@@ -318,9 +585,7 @@ namespace fioio {
             require_auth(actor);
 
             //check that the actor is in the top150.
-            vector<name> top_prods = getTopProds();
-            fio_400_assert((std::find(top_prods.begin(), top_prods.end(), actor)) !=
-                           top_prods.end(), "actor", actor.to_string()," Not a top 150 BP",ErrorFioNameNotReg);
+            fio_400_assert(isTopFeeVoter(actor), "actor", actor.to_string()," Not a top 150 BP",ErrorFioNameNotReg);
 
 
             fio_400_assert(bundled_transactions > 0, "bundled_transactions", to_string(bundled_transactions),
@@ -351,7 +616,7 @@ namespace fioio {
             }
 
             //begin new fees, logic for Mandatory fees.
-            uint128_t endpoint_hash = string_to_uint128_hash(SUBMIT_BUNDLED_TRANSACTION_ENDPOINT);
+            uint128_t endpoint_hash = SUBMIT_BUNDLED_TRANSACTION_ENDPOINT_HASH;
 
             auto fees_by_endpoint = fiofees.get_index<"byendpoint"_n>();
             auto fee_iter = fees_by_endpoint.find(endpoint_hash);
@@ -409,11 +674,8 @@ namespace fioio {
         ) {
             require_auth(actor);
 
-            //check that the actor is in the top42.
-            vector<name> top_prods = getTopProds();
-
-           fio_400_assert((std::find(top_prods.begin(), top_prods.end(), actor)) !=
-                           top_prods.end(), "actor", actor.to_string()," Not a top 150 BP",ErrorFioNameNotReg);
+            //check that the actor is in the top150.
+            fio_400_assert(isTopFeeVoter(actor), "actor", actor.to_string()," Not a top 150 BP",ErrorFioNameNotReg);
 
             fio_400_assert(multiplier > 0, "multiplier", to_string(multiplier),
                            " Must be positive",
@@ -446,32 +708,27 @@ namespace fioio {
             }
 
             //get all voted fees and set votes pending.
-            auto feevotesbybpname = feevotes.get_index<"bybpname"_n>();
-            auto votebyname_iter = feevotesbybpname.find(actor.value);
             auto fees_by_endpoint = fiofees.get_index<"byendpoint"_n>();
 
+            //synced for every voter, see setfeevote.
+            sync_fee_medians();
             if(topprods.find(actor.value) != topprods.end()) {
-
-                if (votebyname_iter != feevotesbybpname.end()) {
-                    //loop over all fee votes, for all voted fees set the pending flag.
-                    for(int i=0;i<votebyname_iter->feevotes.size();i++) {
-                        if (votebyname_iter->block_producer_name.value != actor.value) {
-                            break;
-                        } else {
-
-                            auto fee_iter = fiofees.find(i);
-                            if(fee_iter != fiofees.end()) {
-                                fiofees.modify(fee_iter, _self, [&](struct fiofee &a) {
-                                    a.votes_pending.emplace(true);
-                                });
-                            }
+                vector<feevotevalue> legacyvotes;
+                const vector<feevotevalue> *actorvotes = get_fee_votes(actor, legacyvotes);
+
+                if (actorvotes != nullptr) {
+                    //loop over all fee votes, apply the new multiplier to the fees not in feespending.
+                    for (const auto &vote : *actorvotes) {
+                        if (pendingfees.find(vote.fee_id) == pendingfees.end()) {
+                            const double dresult = multiplier * (double) vote.value;
+                            update_fee_median(vote.fee_id, actor, (uint64_t)(dresult));
                         }
                     }
                 }
             }
 
             //begin new fees, logic for Mandatory fees.
-            uint128_t endpoint_hash = string_to_uint128_hash(SUBMIT_FEE_MULTIPLER_ENDPOINT);
+            uint128_t endpoint_hash = SUBMIT_FEE_MULTIPLER_ENDPOINT_HASH;
 
             auto fee_iter = fees_by_endpoint.find(endpoint_hash);
             //if the fee isnt found for the endpoint, then 400 error.
@@ -630,6 +887,6 @@ namespace fioio {
     };
 
     EOSIO_DISPATCH(FioFee, (setfeevote)(bundlevote)(setfeemult)(computefees)
-                           (mandatoryfee)(bytemandfee)(createfee)
+                           (mandatoryfee)(bytemandfee)(createfee)(migrpending)(migrfeevote)
     )
 }
@@ -9,6 +9,7 @@
 #pragma once
 
 #include <eosiolib/eosio.hpp>
+#include <eosiolib/singleton.hpp>
 
 using std::string;
 
@@ -38,6 +39,13 @@ namespace fioio {
 
         EOSLIB_SERIALIZE( feevalue_ts, (end_point)(value)(timestamp))
     };
+    struct feevotevalue {
+        uint64_t fee_id;        //this is the id of the fee in the fiofees table.
+        int64_t value;          //this it the value of the fee in FIO SUFs (Smallest unit of FIO).
+        uint64_t timestamp = 0; //this is the timestamp when the value was last set.
+
+        EOSLIB_SERIALIZE( feevotevalue, (fee_id)(value)(timestamp))
+    };
     //this is the amount of time that must elapse for votes to be recorded into the FIO protocol for fees.
     const uint32_t TIME_BETWEEN_VOTES_SECONDS = 120;
     const uint32_t TIME_BETWEEN_FEE_VOTES_SECONDS = 3600;
@@ -140,10 +148,91 @@ namespace fioio {
         )
     };
 
+    //this table is replaced by feevotes3, rows are moved to feevotes3 by migrfeevote or
+    //when the producer votes again.
     typedef multi_index<"feevotes2"_n, feevote2,
             indexed_by<"bybpname"_n, const_mem_fun<feevote2, uint64_t, &feevote2::by_bpname>>
     >
     feevotes2_table;
 
+    // This table holds block producer votes for fees, one entry per block producer.
+    // Only the fees the producer voted for are stored, sorted by fee_id.
+    // The votes here will be multiplied by the multiplier in the feevoters table.
+    // @abi table feevotes3 i64
+    struct [[eosio::action]] feevote3 {
+        name block_producer_name;
+        std::vector<feevotevalue> feevotes; //sorted by fee_id
+        uint64_t lastvotetimestamp;
+
+        uint64_t primary_key() const { return block_producer_name.value; }
+
+        EOSLIB_SERIALIZE(feevote3, (block_producer_name)(feevotes)(lastvotetimestamp)
+        )
+    };
+
+    typedef multi_index<"feevotes3"_n, feevote3> feevotes3_table;
+
+    // This table holds the ids of the fees that have votes_pending set, so computefees
+    // takes its work from here instead of scanning the fiofees table.
+    // @abi table feespending i64
+    struct [[eosio::action]] pendingfee {
+        uint64_t fee_id;
+
+        uint64_t primary_key() const { return fee_id; }
+
+        EOSLIB_SERIALIZE(pendingfee, (fee_id)
+        )
+    };
+
+    typedef multi_index<"feespending"_n, pendingfee> pendingfees_table;
+
+    struct producervote {
+        name block_producer_name;
+        uint64_t voted_fee;     //the vote of the producer multiplied by its fee multiplier.
+
+        EOSLIB_SERIALIZE( producervote, (block_producer_name)(voted_fee))
+    };
+
+    // This table holds the votes of the top producers for each fee, sorted by voted_fee,
+    // so the median of a fee can be updated as soon as a top producer votes.
+    // A fee that is in feespending has its votes rebuilt by computefees.
+    // @abi table feemedians i64
+    struct [[eosio::action]] feemedian {
+        uint64_t fee_id;
+        std::vector<producervote> votes;
+
+        uint64_t primary_key() const { return fee_id; }
+
+        EOSLIB_SERIALIZE(feemedian, (fee_id)(votes)
+        )
+    };
+
+    typedef multi_index<"feemedians"_n, feemedian> feemedians_table;
+
+    // The top producers the feemedians votes were built from. When eosio changes topprods
+    // only the votes of the producers entering or leaving it are changed in feemedians.
+    // @abi table medianprods i64
+    struct [[eosio::action]] medianprod {
+        name producer;
+
+        uint64_t primary_key() const { return producer.value; }
+
+        EOSLIB_SERIALIZE(medianprod, (producer)
+        )
+    };
+
+    typedef multi_index<"medianprods"_n, medianprod> medianprods_table;
+
+    // the version of the eosio topprods table medianprods was last synced with.
+    // @abi table medianstate i64
+    struct [[eosio::action]] medianstate {
+        uint64_t topprodsversion = 0;
+
+        EOSLIB_SERIALIZE(medianstate, (topprodsversion)
+        )
+    };
+
+    typedef singleton<"medianstate"_n, medianstate> medianstate_singleton;
+
 
 } // namespace fioio
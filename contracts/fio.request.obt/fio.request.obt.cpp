@@ -246,7 +246,7 @@ namespace fioio {
             string payee_key = account_iter->clientkey;
 
             //begin fees, bundle eligible fee logic
-            uint128_t endpoint_hash = string_to_uint128_hash(RECORD_OBT_DATA_ENDPOINT);
+            uint128_t endpoint_hash = RECORD_OBT_DATA_ENDPOINT_HASH;
 
             auto fees_by_endpoint = fiofees.get_index<"byendpoint"_n>();
             auto fee_iter = fees_by_endpoint.find(endpoint_hash);
@@ -503,7 +503,7 @@ namespace fioio {
             fio_403_assert(account == aActor.value, ErrorSignature);
 
             //begin fees, bundle eligible fee logic
-            const uint128_t endpoint_hash = string_to_uint128_hash(NEW_FUNDS_REQUEST_ENDPOINT);
+            const uint128_t endpoint_hash = NEW_FUNDS_REQUEST_ENDPOINT_HASH;
             auto fees_by_endpoint = fiofees.get_index<"byendpoint"_n>();
             auto fee_iter = fees_by_endpoint.find(endpoint_hash);
 
@@ -719,7 +719,7 @@ namespace fioio {
             fio_403_assert(account == aactor.value, ErrorSignature);
 
             //begin fees, bundle eligible fee logic
-            const uint128_t endpoint_hash = string_to_uint128_hash(REJECT_FUNDS_REQUEST_ENDPOINT);
+            const uint128_t endpoint_hash = REJECT_FUNDS_REQUEST_ENDPOINT_HASH;
 
             auto fees_by_endpoint = fiofees.get_index<"byendpoint"_n>();
             auto fee_iter = fees_by_endpoint.find(endpoint_hash);
@@ -883,7 +883,7 @@ namespace fioio {
         fio_403_assert(account == aactor.value, ErrorSignature);
 
         //begin fees, bundle eligible fee logic
-        const uint128_t endpoint_hash = string_to_uint128_hash(CANCEL_FUNDS_REQUEST_ENDPOINT);
+        const uint128_t endpoint_hash = CANCEL_FUNDS_REQUEST_ENDPOINT_HASH;
 
         auto fees_by_endpoint = fiofees.get_index<"byendpoint"_n>();
         auto fee_iter = fees_by_endpoint.find(endpoint_hash);
@@ -20,8 +20,10 @@
 
 #include <string>
 #include <deque>
+#include <algorithm>
 #include <type_traits>
 #include <optional>
+#include <map>
 
 namespace eosiosystem {
 
@@ -75,7 +77,7 @@ struct [[eosio::table("global"), eosio::contract("fio.system")]] eosio_global_st
     time_point last_pervote_bucket_fill;
     int64_t pervote_bucket = 0;
     int64_t perblock_bucket = 0;
-    uint32_t total_unpaid_blocks = 0; /// all blocks which have been produced but not paid
+    uint32_t total_unpaid_blocks = 0; /* deprecated, moved to block_state */
     int64_t total_voted_fio = 0;
     time_point thresh_voted_fio_time;
     uint16_t last_producer_schedule_size = 0;
@@ -96,7 +98,7 @@ struct [[eosio::table("global"), eosio::contract("fio.system")]] eosio_global_st
  */
 struct [[eosio::table("global2"), eosio::contract("fio.system")]] eosio_global_state2 {
     eosio_global_state2() {}
-    block_timestamp last_block_num; /* deprecated */
+    block_timestamp last_block_num; /* deprecated, moved to block_state */
     double total_producer_votepay_share = 0;
     uint8_t revision = 0; ///< used to track version updates in the future.
 
@@ -115,6 +117,18 @@ struct [[eosio::table("global3"), eosio::contract("fio.system")]] eosio_global_s
     )
 };
 
+/**
+ * the per block counters written by onblock, kept apart from the global state so that
+ * onblock does not serialize the blockchain parameters every block.
+ */
+struct [[eosio::table("blockstate"), eosio::contract("fio.system")]] block_state {
+    block_timestamp last_block_num;
+    uint32_t total_unpaid_blocks = 0; /// all blocks which have been produced but not paid
+
+    EOSLIB_SERIALIZE( block_state, (last_block_num)(total_unpaid_blocks)
+    )
+};
+
 
 //these locks are used for investors and emplyees and members who have grants upon integration.
 //this table holds the list of FIO accounts that hold locked FIO tokens
@@ -146,6 +160,17 @@ struct glockresult {
     uint64_t amount; //amount votable
     EOSLIB_SERIALIZE( glockresult, (lockfound)(amount))
 };
+//the balance and token lock rows of a voter, loaded once per voting power refresh,
+//see eosio::token::get_voting_balance.
+struct voting_balance {
+    uint64_t balance = 0; //fio balance of the voter.
+    bool genesisfound = false; //the voter has a genesis lock.
+    locked_token_holder_info genesislock; //the genesis lock row (lockedtokens).
+    bool generalfound = false; //the voter has a general lock.
+    int32_t generalcanvote = 0; //can_vote of the general lock.
+    uint64_t generalremaining = 0; //remaining_lock_amount of the general lock.
+};
+
 struct lockperiods {
     int64_t duration = 0; //duration in seconds. each duration is seconds after grant creation.
     double percent; //this is the percent to be unlocked
@@ -161,12 +186,15 @@ struct [[eosio::table, eosio::contract("fio.system")]] locked_tokens_info {
     std::vector<lockperiods> periods;// this is the locking periods for the lock
     int64_t remaining_lock_amount = 0; //this is the amount remaining in the lock in FIO SUF, get decremented as unlocking occurs.
     uint32_t timestamp = 0; //this is the time of creation of the lock, locking periods are relative to this time.
+    eosio::binary_extension<std::vector<int64_t>> period_ends; //the period durations sorted, payouts due are found by binary search.
+    eosio::binary_extension<std::vector<uint64_t>> unlocked_amounts; //amount unlocked by periods 0 through i, in period order.
 
     uint64_t primary_key() const { return id; }
     uint64_t by_owner() const{return owner_account.value;}
 
     EOSLIB_SERIALIZE( locked_tokens_info, (id)(owner_account)
             (lock_amount)(payouts_performed)(can_vote)(periods)(remaining_lock_amount)(timestamp)
+            (period_ends)(unlocked_amounts)
     )
 
 };
@@ -192,6 +220,53 @@ struct [[eosio::table, eosio::contract("fio.system")]] top_prod_info {
 typedef eosio::multi_index<"topprods"_n, top_prod_info>
 top_producers_table;
 
+//version of the topprods table, incremented each time a producer enters or leaves it.
+//fio.fee uses it to know when its fee medians must be rebuilt.
+struct [[eosio::table("topprodstate"), eosio::contract("fio.system")]] top_producers_state {
+    uint64_t version = 0;
+
+    EOSLIB_SERIALIZE( top_producers_state, (version)
+    )
+};
+
+typedef eosio::singleton<"topprodstate"_n, top_producers_state> top_producers_state_singleton;
+
+//Producers allowed to vote for fees (the top MAXFEEVOTERBPS active producers by votes),
+//refreshed with the top producers in update_elected_producers.
+struct [[eosio::table, eosio::contract("fio.system")]] top_fee_voter_info {
+    name producer;
+
+    uint64_t primary_key() const { return producer.value; }
+
+    EOSLIB_SERIALIZE( top_fee_voter_info, (producer)
+    )
+};
+
+typedef eosio::multi_index<"topfeeprods"_n, top_fee_voter_info>
+top_fee_voters_table;
+
+//hash of the producer schedule last passed to set_proposed_producers.
+struct [[eosio::table("prodsched"), eosio::contract("fio.system")]] producer_schedule_state {
+    capi_checksum256 schedule_hash;
+
+    EOSLIB_SERIALIZE( producer_schedule_state, (schedule_hash)
+    )
+};
+
+typedef eosio::singleton<"prodsched"_n, producer_schedule_state> producer_schedule_singleton;
+
+//the blocks produced and not yet paid for each producer, updated by onblock every block.
+struct [[eosio::table, eosio::contract("fio.system")]] producer_blocks {
+    name owner;
+    uint32_t unpaid_blocks = 0;
+
+    uint64_t primary_key() const { return owner.value; }
+
+    EOSLIB_SERIALIZE( producer_blocks, (owner)(unpaid_blocks))
+};
+
+typedef eosio::multi_index<"prodblocks"_n, producer_blocks> producer_blocks_table;
+
 
 
 struct [[eosio::table, eosio::contract("fio.system")]] producer_info {
@@ -207,7 +282,7 @@ struct [[eosio::table, eosio::contract("fio.system")]] producer_info {
     eosio::public_key producer_public_key; /// a packed public key object
     bool is_active = true;
     std::string url;
-    uint32_t unpaid_blocks = 0;
+    uint32_t unpaid_blocks = 0; /* deprecated, moved to producer_blocks, frozen until the next resetclaim */
     time_point last_claim_time; //this is the last time a payout was given to this producer.
     uint32_t last_bpclaim;  //this is the last time bpclaim was called for this producer.
     //init this to zero here to ensure that if the location is not specified, sorting will still work.
@@ -283,11 +358,34 @@ indexed_by<"byowner"_n, const_mem_fun<voter_info, uint64_t, &voter_info::by_owne
 
 
 
+//voters whose voting power must be raised, queued by updatepower and drained by updvoters and by
+//voteproducer and voteproxy. an account is queued at most once, the refresh uses the balances and
+//locks at the time it runs.
+struct [[eosio::table, eosio::contract("fio.system")]] dirty_voter {
+    name owner;
+
+    uint64_t primary_key() const { return owner.value; }
+
+    EOSLIB_SERIALIZE( dirty_voter, (owner))
+};
+
+typedef eosio::multi_index<"dirtyvoters"_n, dirty_voter> dirty_voters_table;
+
 //MAS-522 eliminate producers2 table typedef eosio::multi_index<"producers2"_n, producer_info2> producers_table2;
 
 typedef eosio::singleton<"global"_n, eosio_global_state> global_state_singleton;
 typedef eosio::singleton<"global2"_n, eosio_global_state2> global_state2_singleton;
 typedef eosio::singleton<"global3"_n, eosio_global_state3> global_state3_singleton;
+typedef eosio::singleton<"blockstate"_n, block_state> block_state_singleton;
+
+//progress of migrgenlock through the locktokens table.
+struct [[eosio::table("genlockmigr"), eosio::contract("fio.system")]] genlock_migration {
+    uint64_t nextid = 0;
+
+    EOSLIB_SERIALIZE( genlock_migration, (nextid))
+};
+
+typedef eosio::singleton<"genlockmigr"_n, genlock_migration> genlock_migration_singleton;
 
 static constexpr uint32_t seconds_per_day = 24 * 3600;
 
@@ -298,9 +396,12 @@ class [[eosio::contract("fio.system")]] system_contract : public native {
 private:
     voters_table _voters;
     producers_table _producers;
+    producer_blocks_table _prodblocks;
     top_producers_table _topprods;
+    top_fee_voters_table _topfeeprods;
     locked_tokens_table _lockedtokens;
     general_locks_table _generallockedtokens;
+    dirty_voters_table _dirtyvoters;
    //MAS-522 eliminate producers2 producers_table2 _producers2;
     global_state_singleton _global;
     global_state2_singleton _global2;
@@ -308,6 +409,13 @@ private:
     eosio_global_state _gstate;
     eosio_global_state2 _gstate2;
     eosio_global_state3 _gstate3;
+    //set when the matching global state is modified, the destructor only writes back changed state.
+    bool _gstate_changed = false;
+    bool _gstate2_changed = false;
+    bool _gstate3_changed = false;
+    //owner to id of the voters and producers already found in this action, see find_voter.
+    std::map<uint64_t, uint64_t> _voterids;
+    std::map<uint64_t, uint64_t> _producerids;
     fioio::fionames_table _fionames;
     fioio::domains_table _domains;
     fioio::fiofee_table _fiofees;
@@ -342,6 +450,9 @@ public:
     [[eosio::action]]
     void addgenlocked(const name &owner, const vector<lockperiods> &periods, const bool &canvote,const int64_t &amount);
 
+    [[eosio::action]]
+    void migrgenlock(const uint16_t &amount);
+
     [[eosio::action]]
     void onblock(ignore <block_header> header);
 
@@ -380,9 +491,19 @@ public:
     [[eosio::action]]
     void voteproducer(const std::vector<string> &producers, const string &fio_address, const name &actor, const int64_t &max_fee);
 
+    //fee and transfer paths call updatepower after a voter's balance changed. a weight below the
+    //voter's last_vote_weight is applied right away, so no producer (or proxy) keeps votes the voter
+    //no longer holds. a higher weight is queued in dirtyvoters, until it is drained the voter's
+    //producers are credited with the weight of its last refresh. voteproducer and voteproxy refresh
+    //their voter and DIRTYVOTERSPERVOTE queued voters.
     [[eosio::action]]
     void updatepower(const name &voter, bool updateonly);
 
+    //refreshes the votes of up to amount queued voters, starting at the first queued owner >= start.
+    //anyone may call it, see refresh_dirty_voters.
+    [[eosio::action]]
+    void updvoters(const uint16_t &amount, const name &start, const name &actor);
+
     [[eosio::action]]
     void voteproxy(const string &proxy, const string &fio_address, const name &actor, const int64_t &max_fee);
 
@@ -457,17 +578,31 @@ private:
     // defined in voting.hpp
     void update_elected_producers(const block_timestamp& timestamp);
 
-    uint64_t get_votable_balance(const name &tokenowner);
+    uint64_t get_votable_balance(const voting_balance &vb);
 
-    glockresult get_general_votable_balance(const name &tokenowner);
+    glockresult get_general_votable_balance(const voting_balance &vb);
 
     void unlock_tokens(const name &actor);
 
 
     void update_votes(const name &voter, const name &proxy, const std::vector <name> &producers, const bool &voting);
 
+    //the weight update_votes gives the voter from its balance and locks, see get_voting_balance.
+    double get_vote_weight(const voter_info &voter, const bool &voting);
+
+    //true when update_votes can refresh the voter, as it stands, without aborting.
+    bool can_refresh_votes(const voter_info &voter);
+
+    //refreshes up to amount queued voters from start. a voter that can not be refreshed leaves the
+    //queue without a refresh, its next vote refreshes it.
+    void refresh_dirty_voters(const uint16_t &amount, const name &start);
+
     void propagate_weight_change(const voter_info &voter);
 
+    voters_table::const_iterator find_voter(const name &owner);
+
+    producers_table::const_iterator find_producer(const name &owner);
+
     double update_total_votepay_share(time_point ct,
                                       double additional_shares_delta = 0.0, double shares_rate_delta = 0.0);
 
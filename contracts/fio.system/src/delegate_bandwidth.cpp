@@ -64,23 +64,36 @@ namespace eosiosystem {
                 ),
                 "missing required authority of fio.address, fio.treasury, eosio, fio.fee, fio.token, or fio.reqobt");
 
-        auto votersbyowner = _voters.get_index<"byowner"_n>();
-        auto voter_itr = votersbyowner.find(voter.value);
+        auto voter_itr = find_voter(voter);
 
-        if ((voter_itr == votersbyowner.end())&& updateonly) {
+        if ((voter_itr == _voters.end())&& updateonly) {
             //its not there so return.
             return;
         }
-        if ((voter_itr == votersbyowner.end())&& !updateonly) {
+        if ((voter_itr == _voters.end())&& !updateonly) {
              _voters.emplace(voter, [&](auto &v) {
                 v.owner = voter;
             });
              return;
         }
         if (voter_itr->producers.size() || voter_itr->proxy) {
-            update_votes(voter, voter_itr->proxy, voter_itr->producers, false);
+            //a lower weight is applied now, a higher one waits in dirtyvoters.
+            if (get_vote_weight(*voter_itr, false) < voter_itr->last_vote_weight) {
+                update_votes(voter, voter_itr->proxy, voter_itr->producers, false);
+            } else if (_dirtyvoters.find(voter.value) == _dirtyvoters.end()) {
+                _dirtyvoters.emplace(_self, [&](struct dirty_voter &d) {
+                    d.owner = voter;
+                });
+            }
         }
     }
 
+    void system_contract::updvoters(const uint16_t &amount, const name &start, const name &actor) {
+        require_auth(actor);
+        check(amount > 0 && amount <= MAXDIRTYVOTERS, "amount must be between 1 and 50");
+
+        refresh_dirty_voters(amount, start);
+    }
+
 
 } //namespace eosiosystem
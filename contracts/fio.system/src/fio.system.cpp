@@ -21,19 +21,26 @@ namespace eosiosystem {
             : native(s, code, ds),
               _voters(_self, _self.value),
               _producers(_self, _self.value),
+              _prodblocks(_self, _self.value),
               _topprods(_self, _self.value),
+              _topfeeprods(_self, _self.value),
               _global(_self, _self.value),
               _global2(_self, _self.value),
               _global3(_self, _self.value),
               _lockedtokens(_self,_self.value),
               _generallockedtokens(_self, _self.value),
+              _dirtyvoters(_self, _self.value),
               _fionames(AddressContract, AddressContract.value),
               _domains(AddressContract, AddressContract.value),
               _accountmap(AddressContract, AddressContract.value),
               _fiofees(FeeContract, FeeContract.value){
-        _gstate = _global.exists() ? _global.get() : get_default_parameters();
-        _gstate2 = _global2.exists() ? _global2.get() : eosio_global_state2{};
-        _gstate3 = _global3.exists() ? _global3.get() : eosio_global_state3{};
+        //state that does not exist yet is written on the first action, as it always was.
+        _gstate_changed = !_global.exists();
+        _gstate2_changed = !_global2.exists();
+        _gstate3_changed = !_global3.exists();
+        _gstate = _gstate_changed ? get_default_parameters() : _global.get();
+        _gstate2 = _gstate2_changed ? eosio_global_state2{} : _global2.get();
+        _gstate3 = _gstate3_changed ? eosio_global_state3{} : _global3.get();
     }
 
     eosiosystem::eosio_global_state eosiosystem::system_contract::get_default_parameters() {
@@ -58,14 +65,15 @@ namespace eosiosystem {
     }
 
     eosiosystem::system_contract::~system_contract() {
-        _global.set(_gstate, _self);
-        _global2.set(_gstate2, _self);
-        _global3.set(_gstate3, _self);
+        if (_gstate_changed) _global.set(_gstate, _self);
+        if (_gstate2_changed) _global2.set(_gstate2, _self);
+        if (_gstate3_changed) _global3.set(_gstate3, _self);
     }
 
     void eosiosystem::system_contract::setparams(const eosio::blockchain_parameters &params) {
         require_auth(_self);
         (eosio::blockchain_parameters & )(_gstate) = params;
+        _gstate_changed = true;
         check(3 <= _gstate.max_authority_depth, "max_authority_depth should be at least 3");
         set_blockchain_parameters(params);
     }
@@ -99,6 +107,7 @@ namespace eosiosystem {
         check(revision <= 1, // set upper bound to greatest revision supported in the code
               "specified revision is not yet supported by the code");
         _gstate2.revision = revision;
+        _gstate2_changed = true;
     }
 
     /**
@@ -234,9 +243,33 @@ namespace eosiosystem {
             a.periods = periods;
             a.remaining_lock_amount = amount;
             a.timestamp = now();
+            eosio::token::set_general_lock_sums(a);
         });
     }
 
+    //fills period_ends and unlocked_amounts of the general locks created before they were stored,
+    //amount is the number of locks to visit in this call.
+    void eosiosystem::system_contract::migrgenlock(const uint16_t &amount) {
+        require_auth(_self);
+        check(amount > 0 && amount <= 100, "amount must be between 1 and 100");
+
+        genlock_migration_singleton migrationSingleton(_self, _self.value);
+        genlock_migration migration = migrationSingleton.get_or_default(genlock_migration());
+
+        auto lockiter = _generallockedtokens.lower_bound(migration.nextid);
+        for (uint16_t count = 0; lockiter != _generallockedtokens.end() && count < amount; ++lockiter, ++count) {
+            if (!lockiter->unlocked_amounts.has_value()) {
+                _generallockedtokens.modify(lockiter, _self, [&](struct locked_tokens_info &a) {
+                    eosio::token::set_general_lock_sums(a);
+                });
+            }
+        }
+
+        migration.nextid = lockiter == _generallockedtokens.end() ? _generallockedtokens.available_primary_key()
+                                                                  : lockiter->id;
+        migrationSingleton.set(migration, _self);
+    }
+
 } /// fio.system
 
 
@@ -244,10 +277,10 @@ EOSIO_DISPATCH( eosiosystem::system_contract,
 // native.hpp (newaccount definition is actually in fio.system.cpp)
 (newaccount)(addaction)(remaction)(updateauth)(deleteauth)(linkauth)(unlinkauth)(canceldelay)(onerror)(setabi)
 // fio.system.cpp
-(init)(addlocked)(addgenlocked)(setparams)(setpriv)
+(init)(addlocked)(addgenlocked)(migrgenlock)(setparams)(setpriv)
         (rmvproducer)(updtrevision)
 // delegate_bandwidth.cpp
-        (updatepower)
+        (updatepower)(updvoters)
 // voting.cpp
         (regproducer)(regiproducer)(unregprod)(voteproducer)(voteproxy)(inhibitunlck)
         (updlocked)(unlocktokens)(setautoproxy)(crautoproxy)(burnaction)(incram)
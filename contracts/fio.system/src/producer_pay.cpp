@@ -26,28 +26,50 @@ namespace eosiosystem {
         name producer;
         _ds >> timestamp >> producer;
 
-        _gstate2.last_block_num = timestamp;
+        block_state_singleton blockstate(_self, _self.value);
+        block_state bstate;
+        if (blockstate.exists()) {
+            bstate = blockstate.get();
+        } else {
+            //carry over the counters kept in global and global2 before block_state existed.
+            bstate.total_unpaid_blocks = _gstate.total_unpaid_blocks;
+        }
+        bstate.last_block_num = timestamp;
 
         /** until voting activated fio crosses this threshold no new rewards are paid */
         if( _gstate.total_voted_fio < MINVOTEDFIO && _gstate.thresh_voted_fio_time == time_point() ){
+            blockstate.set(bstate, _self);
             return;
         }
 
-        if (_gstate.last_pervote_bucket_fill == time_point())  /// start the presses
+        if (_gstate.last_pervote_bucket_fill == time_point()) {  /// start the presses
             _gstate.last_pervote_bucket_fill = current_time_point();
+            _gstate_changed = true;
+        }
 
 
         /**
          * At startup the initial producer may not be one that is registered / elected
          * and therefore there may be no producer object for them.
          */
-        auto prod = _producers.find(producer.value);
-        if (prod != _producers.end()) {
-            _gstate.total_unpaid_blocks++;
-            _producers.modify(prod, same_payer, [&](auto &p) {
-                p.unpaid_blocks++;
+        auto blocks = _prodblocks.find(producer.value);
+        if (blocks != _prodblocks.end()) {
+            bstate.total_unpaid_blocks++;
+            _prodblocks.modify(blocks, same_payer, [&](auto &b) {
+                b.unpaid_blocks++;
             });
+        } else {
+            auto prod = find_producer(producer);
+            if (prod != _producers.end()) {
+                bstate.total_unpaid_blocks++;
+                //carry over the blocks counted in producer_info before producer_blocks existed.
+                _prodblocks.emplace(_self, [&](auto &b) {
+                    b.owner = producer;
+                    b.unpaid_blocks = prod->unpaid_blocks + 1;
+                });
+            }
         }
+        blockstate.set(bstate, _self);
 
         /// only update block producers once every minute, block_timestamp is in half seconds
         if (timestamp.slot - _gstate.last_producer_schedule_update.slot > 120) {
@@ -60,22 +82,26 @@ namespace eosiosystem {
     void system_contract::resetclaim(const name &producer) {
       check((has_auth(SYSTEMACCOUNT) ||  has_auth(TREASURYACCOUNT)) ,
                "missing required authority of treasury or eosio");
-           auto prodbyowner = _producers.get_index<"byowner"_n>();
-           auto proditer = prodbyowner.find(producer.value);
+           auto proditer = find_producer(producer);
           // Reset producer claim info
-           prodbyowner.modify(proditer, get_self(), [&](auto &p) {
+           _producers.modify(proditer, get_self(), [&](auto &p) {
                p.last_claim_time = time_point {microseconds{static_cast<int64_t>( current_time())}};
                p.unpaid_blocks = 0;
            });
+           auto blocks = _prodblocks.find(producer.value);
+           if (blocks != _prodblocks.end()) {
+               _prodblocks.modify(blocks, get_self(), [&](auto &b) {
+                   b.unpaid_blocks = 0;
+               });
+           }
     }
 
     void system_contract::updlbpclaim(const name &producer) {
         check((has_auth(SYSTEMACCOUNT) ||  has_auth(TREASURYACCOUNT)) ,
               "missing required authority of treasury or eosio");
-        auto prodbyowner = _producers.get_index<"byowner"_n>();
-        auto proditer = prodbyowner.find(producer.value);
+        auto proditer = find_producer(producer);
         // update last_bpclaim
-        prodbyowner.modify(proditer, get_self(), [&](auto &p) {
+        _producers.modify(proditer, get_self(), [&](auto &p) {
             p.last_bpclaim = now();
         });
 
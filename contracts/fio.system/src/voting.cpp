@@ -208,7 +208,7 @@ namespace eosiosystem {
 
         //TODO: REFACTOR FEE ( PROXY / PRODUCER )
         //begin new fees, logic for Mandatory fees.
-        uint128_t endpoint_hash = string_to_uint128_hash(REGISTER_PRODUCER_ENDPOINT);
+        uint128_t endpoint_hash = REGISTER_PRODUCER_ENDPOINT_HASH;
 
         auto fees_by_endpoint = _fiofees.get_index<"byendpoint"_n>();
         auto fee_iter = fees_by_endpoint.find(endpoint_hash);
@@ -299,7 +299,7 @@ namespace eosiosystem {
         });
 
         //begin new fees, logic for Mandatory fees.
-        uint128_t endpoint_hash = string_to_uint128_hash(UNREGISTER_PRODUCER_ENDPOINT);
+        uint128_t endpoint_hash = UNREGISTER_PRODUCER_ENDPOINT_HASH;
 
         auto fees_by_endpoint = _fiofees.get_index<"byendpoint"_n>();
         auto fee_iter = fees_by_endpoint.find(endpoint_hash);
@@ -336,56 +336,43 @@ namespace eosiosystem {
     void system_contract::update_elected_producers(const block_timestamp& block_time) {
 
       _gstate.last_producer_schedule_update = block_time;
+      _gstate_changed = true;
 
       auto idx = _producers.get_index<"prototalvote"_n>();
 
       using value_type = std::pair<eosio::producer_key, uint16_t>;
       std::vector< value_type > top_producers;
       top_producers.reserve(MAXACTIVEBPS);
-
-      vector<name> prevprods;
-
-      //clear _topprods table
-      auto iter = _topprods.begin();
-      while (iter != _topprods.end()) {
-          prevprods.push_back(iter->producer);
-          iter = _topprods.erase(iter);
-
+      std::vector<name> fee_voters;
+      fee_voters.reserve(MAXFEEVOTERBPS);
+
+      for( auto it = idx.cbegin(); it != idx.cend() && fee_voters.size() < MAXFEEVOTERBPS && 0 < it->total_votes && it->active(); ++it ) {
+         if (top_producers.size() < MAXACTIVEBPS) {
+            top_producers.emplace_back(
+                           std::pair<eosio::producer_key, uint16_t>({{it->owner, it->producer_public_key}, it->location}));
+         }
+         fee_voters.push_back(it->owner);
       }
 
-      for( auto it = idx.cbegin(); it != idx.cend() && top_producers.size() < MAXACTIVEBPS && 0 < it->total_votes && it->active(); ++it ) {
-         top_producers.emplace_back(
-                        std::pair<eosio::producer_key, uint16_t>({{it->owner, it->producer_public_key}, it->location}));
-
-         _topprods.emplace(get_self(), [&](auto &p) {
-            p.producer = it->owner;
-          });
-
-          std::vector<name>::iterator pos = std::find(prevprods.begin(), prevprods.end(), it->owner);
-          if (pos != prevprods.end()) {
-              //it was in the list before, do not ajust the resource limits, remove from list
-              prevprods.erase(pos);
-          }
-          else {
-              //it was not in the list before, set it unlimited
-              set_resource_limits(it->owner.value, -1,-1,-1);
+      //update the fee voters the same way as the top producers below, only write the changes.
+      std::sort(fee_voters.begin(), fee_voters.end());
+      auto feeiter = _topfeeprods.begin();
+      auto voteritr = fee_voters.cbegin();
+      while (feeiter != _topfeeprods.end() || voteritr != fee_voters.cend()) {
+          if (voteritr == fee_voters.cend() || (feeiter != _topfeeprods.end() && feeiter->producer < *voteritr)) {
+              feeiter = _topfeeprods.erase(feeiter);
+          } else if (feeiter == _topfeeprods.end() || *voteritr < feeiter->producer) {
+              const name owner = *voteritr;
+              _topfeeprods.emplace(get_self(), [&](auto &p) {
+                  p.producer = owner;
+              });
+              ++voteritr;
+          } else {
+              ++feeiter;
+              ++voteritr;
           }
       }
 
-        //this is the producers exiting the schedule, reset their resoource limits.
-        for(int i=0; i < prevprods.size(); i++){
-            //get the ram that this account has used.
-            int64_t ram = get_account_ram_usage(prevprods[i].value);
-            //increment the ram by the set amount.
-            ram += ADDITIONALRAMBPDESCHEDULING;
-            //set the new limits going forward.
-            set_resource_limits(prevprods[i].value, ram, -1, -1);
-        }
-
-      if( top_producers.size() == 0 || top_producers.size() < _gstate.last_producer_schedule_size ) {
-         return;
-      }
-
       /// sort by producer location, location initialized to zero in fio.system.hpp
       /// location will be set upon call to register producer by the block producer.
       /// the location should be considered as a scheduled order of producers, they should
@@ -396,6 +383,49 @@ namespace eosiosystem {
          // return lhs.second < rhs.second; // sort by location
       } );
 
+      //_topprods is keyed by producer name, walk it along with the sorted top producers
+      //and only write the producers that enter or leave the top producers.
+      bool topchanged = false;
+      auto iter = _topprods.begin();
+      auto topitr = top_producers.cbegin();
+      while (iter != _topprods.end() || topitr != top_producers.cend()) {
+          if (topitr == top_producers.cend() || (iter != _topprods.end() && iter->producer < topitr->first.producer_name)) {
+              //this producer is exiting the schedule, reset its resource limits.
+              //get the ram that this account has used.
+              int64_t ram = get_account_ram_usage(iter->producer.value);
+              //increment the ram by the set amount.
+              ram += ADDITIONALRAMBPDESCHEDULING;
+              //set the new limits going forward.
+              set_resource_limits(iter->producer.value, ram, -1, -1);
+              iter = _topprods.erase(iter);
+              topchanged = true;
+          } else if (iter == _topprods.end() || topitr->first.producer_name < iter->producer) {
+              //it was not in the list before, set it unlimited
+              const name owner = topitr->first.producer_name;
+              _topprods.emplace(get_self(), [&](auto &p) {
+                  p.producer = owner;
+              });
+              set_resource_limits(owner.value, -1, -1, -1);
+              ++topitr;
+              topchanged = true;
+          } else {
+              //it was in the list before, do not ajust the resource limits
+              ++iter;
+              ++topitr;
+          }
+      }
+
+      if (topchanged) {
+         top_producers_state_singleton topprodstate(_self, _self.value);
+         top_producers_state topstate = topprodstate.get_or_default();
+         topstate.version++;
+         topprodstate.set(topstate, _self);
+      }
+
+      if( top_producers.size() == 0 || top_producers.size() < _gstate.last_producer_schedule_size ) {
+         return;
+      }
+
       std::vector<eosio::producer_key> producers;
 
       producers.reserve(top_producers.size());
@@ -403,9 +433,22 @@ namespace eosiosystem {
          producers.push_back( std::move(item.first) );
 
       auto packed_schedule = pack(producers);
+
+      //skip proposing the schedule when neither the producers nor their keys changed.
+      producer_schedule_singleton prodsched(_self, _self.value);
+      producer_schedule_state schedstate;
+      sha256(packed_schedule.data(), packed_schedule.size(), &schedstate.schedule_hash);
+      if (prodsched.exists() &&
+          std::equal(std::begin(schedstate.schedule_hash.hash), std::end(schedstate.schedule_hash.hash),
+                     std::begin(prodsched.get().schedule_hash.hash))) {
+         return;
+      }
+
       if( set_proposed_producers(packed_schedule.data(), packed_schedule.size() ) >= 0 ) {
          _gstate.last_producer_schedule_size = static_cast<decltype(_gstate.last_producer_schedule_size)>( top_producers.size() );
       }
+      //a negative result means the chain already has this schedule pending or active.
+      prodsched.set(schedstate, _self);
     }
 
     double system_contract::update_total_votepay_share(time_point ct,
@@ -418,6 +461,9 @@ namespace eosiosystem {
         }
 
         delta_total_votepay_share += additional_shares_delta;
+        if (delta_total_votepay_share != 0.0) {
+            _gstate2_changed = true;
+        }
         if (delta_total_votepay_share < 0 && _gstate2.total_producer_votepay_share < -delta_total_votepay_share) {
             _gstate2.total_producer_votepay_share = 0.0;
         } else {
@@ -431,6 +477,7 @@ namespace eosiosystem {
         }
 
         _gstate3.last_vpay_state_update = ct;
+        _gstate3_changed = true;
 
         return _gstate2.total_producer_votepay_share;
     }
@@ -501,10 +548,13 @@ namespace eosiosystem {
           bundleeligiblecountdown = voter_iter->bundleeligiblecountdown;
         }
 
+        FioAddressView producerfa;
         for (size_t i = 0; i < producers.size(); i++) {
-          getFioAddressStruct(producers[i], fa);
-          uint128_t nameHash = string_to_uint128_hash(fa.fioaddress.c_str());
-          uint128_t domainHash = string_to_uint128_hash(fa.fiodomain.c_str());
+          //an unparsable producer address can never be registered.
+          fio_400_assert(parseFioAddress(producers[i], producerfa), "fio_address", fio_address,
+                         "FIO Address not registered", ErrorFioNameNotReg);
+          uint128_t nameHash = string_to_uint128_hash(producerfa.fioaddress());
+          uint128_t domainHash = string_to_uint128_hash(producerfa.fiodomain());
 
           auto fioname_iter = namesbyname.find(nameHash);
           fio_400_assert(fioname_iter != namesbyname.end(), "fio_address", fio_address,
@@ -521,8 +571,8 @@ namespace eosiosystem {
           fio_400_assert(domains_iter != domainsbyname.end(), "fio_address", fio_address,
                          "FIO Address not registered", ErrorFioNameNotReg);
 
-          fio_400_assert(now() <= domains_iter->expiration, "domain", fa.fiodomain, "FIO Domain expired",
-                         ErrorDomainExpired);
+          fio_400_assert(now() <= domains_iter->expiration, "domain", string(producerfa.fiodomain()),
+                         "FIO Domain expired", ErrorDomainExpired);
 
           producers_accounts.push_back(name{account});
 
@@ -539,17 +589,13 @@ namespace eosiosystem {
             });
         }
 
-        //note -- we can call these lock token computations like this
-        //only because token locks are exclusive, meaning an account CANNOT have
-        //multiple locked token grants.
-        eosio::token::computeremaininglockedtokens(actor,true);
-        eosio::token::computegenerallockedtokens(actor,true);
-
         sort(producers_accounts.begin(),producers_accounts.end());
 
+        //update_votes records the vesting of the token locks of actor.
         update_votes(actor, proxy, producers_accounts, true);
+        refresh_dirty_voters(DIRTYVOTERSPERVOTE, name());
 
-        uint128_t endpoint_hash = string_to_uint128_hash(VOTE_PRODUCER_ENDPOINT);
+        uint128_t endpoint_hash = VOTE_PRODUCER_ENDPOINT_HASH;
         auto fees_by_endpoint = _fiofees.get_index<"byendpoint"_n>();
         auto fee_iter = fees_by_endpoint.find(endpoint_hash);
 
@@ -687,15 +733,11 @@ namespace eosiosystem {
             });
         }
 
-        //note -- we can call these lock token computations like this
-        //only because token locks are exclusive, meaning an account CANNOT have
-        //multiple locked token grants.
-        eosio::token::computeremaininglockedtokens(actor,true);
-        eosio::token::computegenerallockedtokens(actor,true);
-
+        //update_votes records the vesting of the token locks of actor.
         update_votes(actor, name{account}, producers, true);
+        refresh_dirty_voters(DIRTYVOTERSPERVOTE, name());
 
-        uint128_t endpoint_hash = string_to_uint128_hash(VOTE_PROXY_ENDPOINT);
+        uint128_t endpoint_hash = VOTE_PROXY_ENDPOINT_HASH;
         auto fees_by_endpoint = _fiofees.get_index<"byendpoint"_n>();
         auto fee_iter = fees_by_endpoint.find(endpoint_hash);
 
@@ -765,17 +807,15 @@ namespace eosiosystem {
         eosio::token::computegenerallockedtokens(actor,true);
     }
 
-    uint64_t system_contract::get_votable_balance(const name &tokenowner){
+    uint64_t system_contract::get_votable_balance(const voting_balance &vb){
 
-        //get fio balance for this account,
         uint32_t present_time = now();
-        const auto my_balance = eosio::token::get_balance("fio.token"_n,tokenowner, FIOSYMBOL.code() );
-        uint64_t amount = my_balance.amount;
+        uint64_t amount = vb.balance;
 
         //see if the user is in the lockedtokens table, if so recompute the balance
         //based on grant type.
-        auto lockiter = _lockedtokens.find(tokenowner.value);
-        if(lockiter != _lockedtokens.end()){
+        if(vb.genesisfound){
+            const locked_token_holder_info *lockiter = &vb.genesislock;
             check(amount >= lockiter->remaining_locked_amount,"votable balance lock amount is incoherent.");
             //if lock type 1 always subtract remaining locked amount from balance
             if (lockiter->grant_type == 1) {
@@ -815,24 +855,19 @@ namespace eosiosystem {
         return amount;
     }
 
-    glockresult system_contract::get_general_votable_balance(const name &tokenowner){
+    glockresult system_contract::get_general_votable_balance(const voting_balance &vb){
 
         glockresult res;
-        //get fio balance for this account,
-        uint32_t present_time = now();
-        const auto my_balance = eosio::token::get_balance("fio.token"_n,tokenowner, FIOSYMBOL.code() );
-        uint64_t amount = my_balance.amount;
+        uint64_t amount = vb.balance;
 
-        auto locks_by_owner = _generallockedtokens.get_index<"byowner"_n>();
-        auto lockiter = locks_by_owner.find(tokenowner.value);
-        if(lockiter != locks_by_owner.end()){
+        if(vb.generalfound){
             res.lockfound = true;
             //if can vote --
-            if (lockiter->can_vote == 1){
+            if (vb.generalcanvote == 1){
                 res.amount = amount;
             }else{
-                if (amount > lockiter->remaining_lock_amount) {
-                    res.amount =  amount - lockiter->remaining_lock_amount;
+                if (amount > vb.generalremaining) {
+                    res.amount =  amount - vb.generalremaining;
                 }else{
                     res.amount = 0;
                 }
@@ -845,6 +880,101 @@ namespace eosiosystem {
     }
 
 
+    /**
+     * looks up the voter of an account by owner. the first lookup of an owner in an action goes through
+     * the byowner index, later lookups of the same owner are a primary key find on the row already loaded,
+     * update_votes and propagate_weight_change look up the same voters and proxies several times.
+     * @param owner the account of the voter
+     * @return iterator into _voters, _voters.end() when the account has no voter record.
+     */
+    voters_table::const_iterator system_contract::find_voter(const name &owner) {
+        auto cached = _voterids.find(owner.value);
+        if (cached != _voterids.end()) {
+            return _voters.find(cached->second);
+        }
+        auto votersbyowner = _voters.get_index<"byowner"_n>();
+        auto voter = votersbyowner.find(owner.value);
+        if (voter == votersbyowner.end()) {
+            return _voters.end();
+        }
+        _voterids[owner.value] = voter->id;
+        return _voters.iterator_to(*voter);
+    }
+
+    //same as find_voter for the producers table.
+    producers_table::const_iterator system_contract::find_producer(const name &owner) {
+        auto cached = _producerids.find(owner.value);
+        if (cached != _producerids.end()) {
+            return _producers.find(cached->second);
+        }
+        auto prodbyowner = _producers.get_index<"byowner"_n>();
+        auto prod = prodbyowner.find(owner.value);
+        if (prod == prodbyowner.end()) {
+            return _producers.end();
+        }
+        _producerids[owner.value] = prod->id;
+        return _producers.iterator_to(*prod);
+    }
+
+    double system_contract::get_vote_weight(const voter_info &voter, const bool &voting) {
+        uint64_t amount = 0;
+        //get fio balance and token locks for this account once for both lock types.
+        const voting_balance vb = eosio::token::get_voting_balance(voter.owner, voting);
+        glockresult res = get_general_votable_balance(vb);
+        if(res.lockfound){
+            amount = res.amount;
+        }else {
+            amount = get_votable_balance(vb);
+        }
+
+        auto weight = (double)amount;
+        if (voter.is_proxy) {
+            weight += voter.proxied_vote_weight;
+        }
+        return weight;
+    }
+
+    bool system_contract::can_refresh_votes(const voter_info &voter) {
+        //get_votable_balance aborts when the balance is below the genesis lock.
+        auto coherent = [&](const name &owner) {
+            const voting_balance vb = eosio::token::get_voting_balance(owner, false);
+            return !vb.genesisfound || vb.balance >= vb.genesislock.remaining_locked_amount;
+        };
+        if (!coherent(voter.owner)) {
+            return false;
+        }
+
+        //the weight change reaches the producers of the voter, or of its proxy.
+        const std::vector <name> *producers = &voter.producers;
+        if (voter.proxy) {
+            auto proxy = find_voter(voter.proxy);
+            if (proxy == _voters.end() || proxy->proxy || !coherent(proxy->owner)) {
+                return false;
+            }
+            producers = &proxy->producers;
+        }
+        for (const auto &p : *producers) {
+            if (find_producer(p) == _producers.end()) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    void system_contract::refresh_dirty_voters(const uint16_t &amount, const name &start) {
+        auto dirtyiter = _dirtyvoters.lower_bound(start.value);
+        for (uint16_t count = 0; count < amount && dirtyiter != _dirtyvoters.end(); count++) {
+            const name voter = dirtyiter->owner;
+            dirtyiter = _dirtyvoters.erase(dirtyiter);
+
+            auto voter_itr = find_voter(voter);
+            if (voter_itr != _voters.end() && (voter_itr->producers.size() || voter_itr->proxy) &&
+                can_refresh_votes(*voter_itr)) {
+                update_votes(voter, voter_itr->proxy, voter_itr->producers, false);
+            }
+        }
+    }
+
     void system_contract::update_votes(
             const name &voter_name,
             const name &proxy,
@@ -860,30 +990,23 @@ namespace eosiosystem {
                 check(producers[i - 1] < producers[i], "producer votes must be unique and sorted");
             }
         }
-        auto votersbyowner = _voters.get_index<"byowner"_n>();
-        auto voter = votersbyowner.find(voter_name.value);
-        check(voter != votersbyowner.end(), "user must vote before votes can be updated");
-        check(!proxy || !voter->is_proxy, "account registered as a proxy is not allowed to use a proxy");
+        auto voter = find_voter(voter_name);
+        check(voter != _voters.end(), "user must vote before votes can be updated");
 
-
-        //change to get_unlocked_balance() Ed 11/25/2019
-        uint64_t amount = 0;
-        glockresult res = get_general_votable_balance(voter->owner);
-        if(res.lockfound){
-            amount = res.amount;
-        }else {
-           amount = get_votable_balance(voter->owner);
+        //this refresh covers any pending updatepower for the voter.
+        auto dirtyiter = _dirtyvoters.find(voter_name.value);
+        if (dirtyiter != _dirtyvoters.end()) {
+            _dirtyvoters.erase(dirtyiter);
         }
-
-        //on the first vote we update the total voted fio.
+        check(!proxy || !voter->is_proxy, "account registered as a proxy is not allowed to use a proxy");
 
 
-        auto new_vote_weight = (double)amount;
-        if (voter->is_proxy) {
-            new_vote_weight += voter->proxied_vote_weight;
-        }
+        //change to get_unlocked_balance() Ed 11/25/2019
+        //voting records the vesting of the locks first.
+        auto new_vote_weight = get_vote_weight(*voter, voting);
 
         if( !(proxy) ) {
+            _gstate_changed = true;
 
             if( voter->last_vote_weight > 0.0 ) {
                 _gstate.total_voted_fio -= voter->last_vote_weight;
@@ -900,9 +1023,9 @@ namespace eosiosystem {
         boost::container::flat_map <name, pair<double, bool /*new*/>> producer_deltas;
         if (voter->last_vote_weight > 0) {
             if (voter->proxy) {
-                auto old_proxy = votersbyowner.find(voter->proxy.value);
-                check(old_proxy != votersbyowner.end(), "old proxy not found"); //data corruption
-                votersbyowner.modify(old_proxy, same_payer, [&](auto &vp) {
+                auto old_proxy = find_voter(voter->proxy);
+                check(old_proxy != _voters.end(), "old proxy not found"); //data corruption
+                _voters.modify(old_proxy, same_payer, [&](auto &vp) {
                     vp.proxied_vote_weight -= voter->last_vote_weight;
                 });
                 propagate_weight_change(*old_proxy);
@@ -916,12 +1039,12 @@ namespace eosiosystem {
         }
 
         if (proxy) {
-            auto new_proxy = votersbyowner.find(proxy.value);
-            check(new_proxy != votersbyowner.end(),
+            auto new_proxy = find_voter(proxy);
+            check(new_proxy != _voters.end(),
                   "invalid proxy specified"); //if ( !voting ) { data corruption } else { wrong vote }
             fio_403_assert(!voting || new_proxy->is_proxy, ErrorProxyNotFound);
             if (new_vote_weight >= 0) {
-                votersbyowner.modify(new_proxy, same_payer, [&](auto &vp) {
+                _voters.modify(new_proxy, same_payer, [&](auto &vp) {
                     vp.proxied_vote_weight += new_vote_weight;
                 });
                 propagate_weight_change(*new_proxy);
@@ -939,19 +1062,19 @@ namespace eosiosystem {
         const auto ct = current_time_point();
         double delta_change_rate = 0.0;
         double total_inactive_vpay_share = 0.0;
-        auto prodbyowner = _producers.get_index<"byowner"_n>();
         for (const auto &pd : producer_deltas) {
-            auto pitr = prodbyowner.find(pd.first.value);
-            if (pitr != prodbyowner.end()) {
+            auto pitr = find_producer(pd.first);
+            if (pitr != _producers.end()) {
                 check(!voting || pitr->active() || !pd.second.second /* not from new set */,
                       "Invalid or duplicated producers1");
                 double init_total_votes = pitr->total_votes;
-                prodbyowner.modify(pitr, same_payer, [&](auto &p) {
+                _producers.modify(pitr, same_payer, [&](auto &p) {
                     p.total_votes += pd.second.first;
                     if (p.total_votes < 0) { // floating point arithmetics can give small negative numbers
                         p.total_votes = 0;
                     }
                     _gstate.total_producer_vote_weight += pd.second.first;
+                    _gstate_changed = true;
                     //check( p.total_votes >= 0, "something bad happened" );
                 });
             } else {
@@ -962,7 +1085,7 @@ namespace eosiosystem {
 
         update_total_votepay_share(ct, -total_inactive_vpay_share, delta_change_rate);
 
-        votersbyowner.modify(voter, same_payer, [&](auto &av) {
+        _voters.modify(voter, same_payer, [&](auto &av) {
             av.last_vote_weight = new_vote_weight;
             av.producers = producers;
             av.proxy = proxy;
@@ -994,14 +1117,13 @@ namespace eosiosystem {
         //first verify that the proxy exists and is registered as a proxy.
         //look it up and check it.
         //if its there then emplace the owner record into the voting_info table with is_auto_proxy set.
-        auto votersbyowner = _voters.get_index<"byowner"_n>();
-        auto itervi = votersbyowner.find(proxy.value);
-        check(itervi != votersbyowner.end(), "specified proxy not found.");
+        auto itervi = find_voter(proxy);
+        check(itervi != _voters.end(), "specified proxy not found.");
         check(itervi->is_proxy == true,"specified proxy is not registered as a proxy");
 
-        itervi = votersbyowner.find(owner.value);
-        check(itervi != votersbyowner.end(), "specified owner not found.");
-        votersbyowner.modify(itervi, same_payer, [&](auto &av) {
+        itervi = find_voter(owner);
+        check(itervi != _voters.end(), "specified owner not found.");
+        _voters.modify(itervi, same_payer, [&](auto &av) {
             av.is_auto_proxy = true;
             av.proxy = proxy;
         });
@@ -1081,7 +1203,7 @@ namespace eosiosystem {
         regiproxy(actor,fio_address,false);
 
         //begin new fees, logic for Mandatory fees.
-        uint128_t endpoint_hash = string_to_uint128_hash(UNREGISTER_PROXY_ENDPOINT);
+        uint128_t endpoint_hash = UNREGISTER_PROXY_ENDPOINT_HASH;
 
         auto fees_by_endpoint = _fiofees.get_index<"byendpoint"_n>();
         auto fee_iter = fees_by_endpoint.find(endpoint_hash);
@@ -1159,7 +1281,7 @@ namespace eosiosystem {
         regiproxy(actor,fio_address,true);
 
         //begin new fees, logic for Mandatory fees.
-        uint128_t endpoint_hash = string_to_uint128_hash(REGISTER_PROXY_ENDPOINT);
+        uint128_t endpoint_hash = REGISTER_PROXY_ENDPOINT_HASH;
 
         auto fees_by_endpoint = _fiofees.get_index<"byendpoint"_n>();
         auto fee_iter = fees_by_endpoint.find(endpoint_hash);
@@ -1273,28 +1395,17 @@ namespace eosiosystem {
     void system_contract::propagate_weight_change(const voter_info &voter) {
         check(!voter.proxy || !voter.is_proxy, "account registered as a proxy is not allowed to use a proxy");
 
-        uint64_t amount = 0;
-        glockresult res = get_general_votable_balance(voter.owner);
-        if(res.lockfound){
-            amount = res.amount;
-        }else {
-            amount = get_votable_balance(voter.owner);
-        }
         //instead of staked we use the voters current FIO balance MAS-522 eliminate stake from voting.
-        auto new_weight = (double)amount;
-        if (voter.is_proxy) {
-            new_weight += voter.proxied_vote_weight;
-        }
-        auto votersbyowner = _voters.get_index<"byowner"_n>();
+        auto new_weight = get_vote_weight(voter, false);
 
         /// don't propagate small changes (1 ~= epsilon)
         if (fabs(new_weight - voter.last_vote_weight) > 1) {
             if (voter.proxy) {
 
-                auto pitr = votersbyowner.find(voter.proxy.value);
-                check(pitr != votersbyowner.end(),"proxy not found");
+                auto pitr = find_voter(voter.proxy);
+                check(pitr != _voters.end(),"proxy not found");
 
-                votersbyowner.modify(pitr, same_payer, [&](auto &p) {
+                _voters.modify(pitr, same_payer, [&](auto &p) {
                                    p.proxied_vote_weight += new_weight - voter.last_vote_weight;
                                }
                 );
@@ -1305,23 +1416,24 @@ namespace eosiosystem {
                 double delta_change_rate = 0;
                 double total_inactive_vpay_share = 0;
                 for (auto acnt : voter.producers) {
-                    auto prodbyowner = _producers.get_index<"byowner"_n>();
-                    auto prod =  prodbyowner.find(acnt.value);
-                    check(prod != prodbyowner.end(), "producer not found"); //data corruption
+                    auto prod = find_producer(acnt);
+                    check(prod != _producers.end(), "producer not found"); //data corruption
                     const double init_total_votes = prod->total_votes;
-                    prodbyowner.modify(prod, same_payer, [&](auto &p) {
+                    _producers.modify(prod, same_payer, [&](auto &p) {
                         p.total_votes += delta;
                         _gstate.total_producer_vote_weight += delta;
+                        _gstate_changed = true;
                     });
                 }
 
                 update_total_votepay_share(ct, -total_inactive_vpay_share, delta_change_rate);
             }
         }
-        auto pitr = votersbyowner.find(voter.owner.value);
-        check(pitr != votersbyowner.end(),"voter not found");
+        auto pitr = find_voter(voter.owner);
+        check(pitr != _voters.end(),"voter not found");
 
         //adapt the total voted fio.
+        _gstate_changed = true;
         if( pitr->last_vote_weight > 0.0 ) {
             _gstate.total_voted_fio -= pitr->last_vote_weight;
         }
@@ -1332,7 +1444,7 @@ namespace eosiosystem {
             _gstate.thresh_voted_fio_time = current_time_point();
         }
 
-        votersbyowner.modify(pitr, same_payer, [&](auto &v) {
+        _voters.modify(pitr, same_payer, [&](auto &v) {
                            v.last_vote_weight = new_weight;
                        }
         );
@@ -23,6 +23,13 @@ namespace eosio {
 
     using std::string;
 
+    // A payee and the amount sent to it by trnsfiopubkys.
+    struct transferpayee {
+        string payee_public_key;
+        int64_t amount;
+        EOSLIB_SERIALIZE( transferpayee, (payee_public_key)(amount))
+    };
+
     class [[eosio::contract("fio.token")]] token : public contract {
     private:
         fioio::eosio_names_table eosionames;
@@ -72,6 +79,12 @@ namespace eosio {
                           const name &actor,
                           const string &tpid);
 
+        [[eosio::action]]
+        void trnsfiopubkys(const vector<transferpayee> &payees,
+                           const int64_t &max_fee,
+                           const name &actor,
+                           const string &tpid);
+
         [[eosio::action]]
         void trnsloctoks(const string &payee_public_key,
                                 const int32_t &can_vote,
@@ -123,10 +136,8 @@ namespace eosio {
 
         void add_balance(name owner, asset value, name ram_payer);
 
-        bool can_transfer(const name &tokenowner, const uint64_t &feeamount, const uint64_t &transferamount,
-                          const bool &isfee);
-
-        bool can_transfer_general(const name &tokenowner,const uint64_t &transferamount);
+        name bind_payee_account(const string &payee_public_key, const bool &errorifaccountexists,
+                                bool &accountExists);
 
         name transfer_public_key(const string &payee_public_key,
                                         const int64_t &amount,
@@ -153,274 +164,398 @@ namespace eosio {
 
 
 
+        struct vesting_result {
+            uint64_t remaining = 0;   //locked amount remaining after vesting.
+            uint32_t payouts = 0;     //payout periods newly unlocked by vesting.
+            bool unlocked = false;    //vesting unlocked periods the lock row does not record yet.
+        };
+
+        //unlock schedule of a genesis grant type, see evaluate_genesis_vesting.
+        struct genesis_schedule {
+            bool known;              //grant type exists.
+            uint64_t firstpercent;   //percent of the grant unlocked 90 days after the grant.
+            uint64_t periodpercent;  //percent unlocked every 180 days after that, 3 decimal places, 0 does not vest.
+        };
+
+        //indexed by grant_type.
+        static constexpr uint32_t GENESISGRANTTYPES = 5;
+        static constexpr genesis_schedule GENESISSCHEDULES[GENESISGRANTTYPES] = {
+                {false, 0, 0},
+                {true,  6, 18800},
+                {true,  6, 18800},
+                {true,  6, 18800},
+                {true,  0, 0}
+        };
+        static constexpr uint64_t GENESISFIRSTPAYDAYS = 90;
+        static constexpr uint64_t GENESISPAYOUTDAYS = 180;
+        static constexpr uint64_t GENESISPAYOUTS = 6;
+
+        static const genesis_schedule &get_genesis_schedule(const uint32_t &grant_type) {
+            return GENESISSCHEDULES[grant_type < GENESISGRANTTYPES ? grant_type : 0];
+        }
+
+        //amount unlocked by the first unlock period.
+        static uint64_t genesis_first_amount(const genesis_schedule &schedule, const uint64_t &totalgrantamount) {
+            return (totalgrantamount / 100) * schedule.firstpercent;
+        }
+
+        //amount unlocked by payouts periods after the first, the last 4 digits of the SUFs are
+        //dropped to avoid overflow.
+        static uint64_t genesis_period_amount(const genesis_schedule &schedule, const uint64_t &totalgrantamount,
+                                              const uint64_t &payouts) {
+            return ((payouts * ((totalgrantamount / 10000) * schedule.periodpercent)) / 100000) * 10000;
+        }
+
+        //this will compute the vesting of a genesis grant (lockedtokens) at present_time,
+        //the table is not modified.
+        static vesting_result evaluate_genesis_vesting(const eosiosystem::locked_token_holder_info &lock,
+                                                       const uint32_t &present_time) {
+            vesting_result res;
+            res.remaining = lock.remaining_locked_amount;
+
+            if ((lock.inhibit_unlocking && (lock.grant_type == 2)) || (lock.unlocked_period_count >= GENESISPAYOUTS)) {
+                return res;
+            }
+
+            const uint64_t daysSinceGrant = (present_time - lock.timestamp) / SECONDSPERDAY;
+            const uint64_t payoutsDue = daysSinceGrant > GENESISFIRSTPAYDAYS ?
+                                        std::min((daysSinceGrant - GENESISFIRSTPAYDAYS) / GENESISPAYOUTDAYS, GENESISPAYOUTS) : 0;
+            //the first unlocking period is counted in unlocked_period_count.
+            const uint64_t payoutsDone = lock.unlocked_period_count > 0 ? lock.unlocked_period_count - 1 : 0;
+            const bool firstDue = (lock.unlocked_period_count == 0) && (daysSinceGrant >= GENESISFIRSTPAYDAYS);
+            const bool periodsDue = payoutsDue > payoutsDone;
+
+            const genesis_schedule &schedule = get_genesis_schedule(lock.grant_type);
+            check(!firstDue || schedule.known, "unknown grant type");
+            if (!firstDue && !periodsDue) {
+                return res;
+            }
+            if (periodsDue && (schedule.periodpercent == 0)) {
+                //grants that do not vest past the first period are not unlocked.
+                return res;
+            }
+
+            uint64_t newlockedamount = lock.remaining_locked_amount;
+            if (firstDue) {
+                const uint64_t amountpay = genesis_first_amount(schedule, lock.total_grant_amount);
+                newlockedamount = newlockedamount > amountpay ? newlockedamount - amountpay : 0;
+            }
+            const uint64_t remainingPayouts = periodsDue ? payoutsDue - payoutsDone : 0;
+            if (periodsDue) {
+                const uint64_t amountpay = genesis_period_amount(schedule, lock.total_grant_amount, remainingPayouts);
+                newlockedamount = newlockedamount > amountpay ? newlockedamount - amountpay : 0;
+            }
+
+            res.remaining = newlockedamount;
+            res.payouts = remainingPayouts + (firstDue ? 1 : 0);
+            res.unlocked = true;
+            return res;
+        }
+
+        //this logic corrects the locked token accounting for accounts suffering from the bug
+        //discovered in the second period unlocking. returns true and sets remaining when the
+        //lock row holds more than should remain locked after the second unlock period,
+        //computed the same way as the unlock itself.
+        static bool genesis_period2_correction(const eosiosystem::locked_token_holder_info &lock,
+                                               uint64_t &remaining) {
+            if ((lock.inhibit_unlocking && (lock.grant_type == 2)) || (lock.unlocked_period_count != 2)) {
+                return false;
+            }
+            const genesis_schedule &schedule = get_genesis_schedule(lock.grant_type);
+            if (schedule.periodpercent == 0) {
+                return false;
+            }
+
+            const uint64_t totalunlock = genesis_first_amount(schedule, lock.total_grant_amount) +
+                                         genesis_period_amount(schedule, lock.total_grant_amount, 1);
+            if (lock.total_grant_amount < totalunlock) {
+                //at most 24.8% of the grant is unlocked here, if this went neg for some reason
+                //just leave the lock amount as it is.
+                return false;
+            }
+
+            const uint64_t nremaininglocked = lock.total_grant_amount - totalunlock;
+            if (nremaininglocked < lock.remaining_locked_amount) {
+                remaining = nremaininglocked;
+                return true;
+            }
+            return false;
+        }
+
+        //caps a remaining locked amount to amount, the fio balance of the account.
+        static uint64_t cap_locked_to_amount(const uint64_t &amount, uint64_t lockedamount) {
+            if (lockedamount > amount) {
+                print(" WARNING computed amount ", lockedamount, " is more than amount in account ",
+                      amount, " \n ",
+                      " Transaction processing order can cause this, this amount is being re-aligned, resetting remaining locked amount to ",
+                      amount, "\n");
+                lockedamount = amount;
+            }
+            return lockedamount;
+        }
+
         //this will compute the present unlocked tokens for this user based on the
         //unlocking schedule, it will update the lockedtokens table if the doupdate
         //is set to true.
         static uint64_t computeremaininglockedtokens(const name &actor, bool doupdate) {
-            uint32_t present_time = now();
-
             eosiosystem::locked_tokens_table lockedTokensTable(SYSTEMACCOUNT, SYSTEMACCOUNT.value);
             auto lockiter = lockedTokensTable.find(actor.value);
-            if (lockiter != lockedTokensTable.end()) {
-                if (lockiter->inhibit_unlocking && (lockiter->grant_type == 2)) {
-                    return lockiter->remaining_locked_amount;
-                }
-                if (lockiter->unlocked_period_count < 6) {
-                    //to shorten the vesting schedule adapt these variables.
-                    uint32_t daysSinceGrant = (int) ((present_time - lockiter->timestamp) / SECONDSPERDAY);
-                    uint32_t firstPayPeriod = 90;
-                    uint32_t payoutTimePeriod = 180;
-
-                    //TEST LOCKED TOKENS uint32_t daysSinceGrant =  (int)((present_time  - lockiter->timestamp) / 60);
-                    //TEST LOCKED TOKENS uint32_t firstPayPeriod = 15;
-                    //TEST LOCKED TOKENS uint32_t payoutTimePeriod = 15;
-
-                    bool ninetyDaysSinceGrant = daysSinceGrant >= firstPayPeriod;
-
-                    uint64_t payoutsDue = 0;
-                    if (daysSinceGrant > firstPayPeriod) {
-                        daysSinceGrant -= firstPayPeriod;
-                        payoutsDue = daysSinceGrant / payoutTimePeriod;
-                        if (payoutsDue > 6) {
-                            payoutsDue = 6;
-                        }
-                    }
+            if (lockiter == lockedTokensTable.end()) {
+                return 0;
+            }
 
-                    uint64_t numberVestingPayouts = lockiter->unlocked_period_count;
-                    uint64_t remainingPayouts = 0;
-                    uint64_t newlockedamount = lockiter->remaining_locked_amount;
-                    uint64_t totalgrantamount = lockiter->total_grant_amount;
-                    uint64_t amountpay = 0;
-                    uint64_t addone = 0;
-                    bool didsomething = false;
-
-
-                    //this logic corrects the locked token accounting for accounts suffering from the bug
-                    //discovered in the second period unlocking.
-
-                    // verify the unlock_period_count_against the remaining_locked_amount, correct
-                    //it if necessary,
-                    //NOTE -- this distinct logic block is placed purposefully,
-                    // there is duplicate code here, and local vars, the intention is to
-                    // ensure there are NO side effects to other logical sections of this code.
-                    //the intention is to ensure that the logic used to calculate the unlock is
-                    //exactly the same as that used during the unlock.
-                    //the performance implications of this new code is that this code will run for every
-                    //vote, proxy, or transfer during the second unlocking period, if an account is mis-accounted
-                    //it will run all of the logic to resolve the accounting. if an account is not mis-accounted
-                    // the overhead is about 6 extra computations being performed during unlock period 2
-                    // for all transfers votes and proxys.
-                    if ((numberVestingPayouts == 2)&&
-                        ((lockiter->grant_type == 1) ||
-                         (lockiter->grant_type == 2) ||
-                         (lockiter->grant_type == 3)) && doupdate)
-                    {
-                        //we will compute the total we should have unlocked in this period.
-                        //if the amount is greater than what has been unlocked so far we will
-                        //correct the amount to be unlocked.
-                        uint64_t totalunlock = 0;
-                        uint64_t nremaininglocked = 0;
-                        //compute the first unlock the same way as it was computed during unlock.
-                        totalunlock = (totalgrantamount / 100) * 6;
-                        //apply the new logic to reduce the size of the calculations for the remaining percent.
-                        //do this in the same way as it was performed in the unlock.
-                        uint64_t totalgrantsmaller = totalgrantamount / 10000;
-                        // compute the amount that should have been unlocked in the
-                        // second unlock period.
-                        totalunlock += ((( (totalgrantsmaller * 18800)) / 100000) * 10000);
-                        if (totalgrantamount >= totalunlock) {
-                            nremaininglocked = (totalgrantamount - totalunlock);
-                        }
-                        else {
-                            //if this went neg for some reason, just leave the lock amount as it is.
-                            return lockiter->remaining_locked_amount;
-                        }
-
-                        //if the computed remaining locked amount for period 2 is less than the present
-                        //remaining locked amount then set the new value using the same logic that
-                        //was used during the unlock period.
-                        if (nremaininglocked < newlockedamount) {
-                            const auto my_balance = eosio::token::get_balance("fio.token"_n, actor,
-                                                                              FIOSYMBOL.code());
-                            uint64_t amount = my_balance.amount;
-
-                            if (nremaininglocked > amount) {
-                                print(" WARNING computed amount ", nremaininglocked,
-                                      " is more than amount in account ",
-                                      amount, " \n ",
-                                      " Transaction processing order can cause this, this amount is being re-aligned, resetting remaining locked amount to ",
-                                      amount, "\n");
-                                nremaininglocked = amount;
-                            }
-
-                            lockedTokensTable.modify(lockiter, SYSTEMACCOUNT, [&](auto &av) {
-                                av.remaining_locked_amount = nremaininglocked;
-                            });
-                        }
-                    }
+            if (!doupdate) {
+                return evaluate_genesis_vesting(*lockiter, now()).remaining;
+            }
+            return record_genesis_vesting(lockedTokensTable, lockiter, [&]() {
+                return eosio::token::get_balance("fio.token"_n, actor, FIOSYMBOL.code()).amount;
+            });
+        }
 
-                    //process the first unlock period.
-                    if ((numberVestingPayouts == 0) && (ninetyDaysSinceGrant)) {
-                        if ((lockiter->grant_type == 1) ||
-                            (lockiter->grant_type == 2) ||
-                            (lockiter->grant_type == 3)) {
-                            //pay out 1% for type 1
-                            amountpay = (totalgrantamount / 100) * 6;
-                        } else if (lockiter->grant_type == 4) {
-                            //pay out 0 for type 4
-                            amountpay = 0;
-                        } else {
-                            check(false, "unknown grant type");
-                        }
-
-                        if (newlockedamount > amountpay) {
-                            newlockedamount -= amountpay;
-                        } else {
-                            newlockedamount = 0;
-                        }
-                        addone = 1;
-                        didsomething = true;
-                    }
+        //this records the vesting of the genesis lock at lockiter in the lockedtokens table and returns
+        //the remaining locked amount. getbalance returns the fio balance of the account, it is only
+        //called when the lock has to be capped to the balance.
+        template<typename Balance>
+        static uint64_t record_genesis_vesting(eosiosystem::locked_tokens_table &lockedTokensTable,
+                                               const eosiosystem::locked_tokens_table::const_iterator &lockiter,
+                                               const Balance &getbalance) {
+            const vesting_result vest = evaluate_genesis_vesting(*lockiter, now());
+
+            uint64_t nremaininglocked = 0;
+            if (genesis_period2_correction(*lockiter, nremaininglocked)) {
+                nremaininglocked = cap_locked_to_amount(getbalance(), nremaininglocked);
+                lockedTokensTable.modify(lockiter, SYSTEMACCOUNT, [&](auto &av) {
+                    av.remaining_locked_amount = nremaininglocked;
+                });
+            }
 
-                    //this accounts for the first unlocking period being the day 0 unlocking period.
-                    if (numberVestingPayouts > 0) {
-                        numberVestingPayouts--;
-                    }
+            if (!vest.unlocked) {
+                return vest.remaining;
+            }
 
-                    //process the rest of the payout periods, other than the first period.
-                    if (payoutsDue > numberVestingPayouts) {
-                        remainingPayouts = payoutsDue - numberVestingPayouts;
-                        uint64_t percentperblock = 0;
-                        if ((lockiter->grant_type == 1) ||
-                            (lockiter->grant_type == 2) ||
-                            (lockiter->grant_type == 3)) {
-                            //this logic assumes to have 3 decimal places in the specified percentage
-                            percentperblock = 18800;
-                        } else if (lockiter->grant_type == 4) {
-                            //this is assumed to have 3 decimal places in the specified percentage
-                            return lockiter->remaining_locked_amount;
-                        } else {  //unknown lock type, dont unlock
-                            return lockiter->remaining_locked_amount;
-                        }
-
-                        //we eliminate the last 5 digits of the SUFs to avoid overflow in the calculations
-                        //that follow.
-                        uint64_t totalgrantsmaller = totalgrantamount/10000;
-                        amountpay = ((remainingPayouts * (totalgrantsmaller * percentperblock)) / 100000) * 10000;
-
-                        if (newlockedamount > amountpay) {
-                            newlockedamount -= amountpay;
-                        } else {
-                            newlockedamount = 0;
-                        }
-                        didsomething = true;
-                    }
+            const uint64_t newlockedamount = cap_locked_to_amount(getbalance(), vest.remaining);
+            //update the locked table.
+            lockedTokensTable.modify(lockiter, SYSTEMACCOUNT, [&](auto &av) {
+                av.remaining_locked_amount = newlockedamount;
+                av.unlocked_period_count += vest.payouts;
+            });
+            return newlockedamount;
+        }
+
+        //begin general locked tokens
+        //amount unlocked by period i of a general lock.
+        static uint64_t general_lock_period_amount(const eosiosystem::locked_tokens_info &lock, const size_t &i) {
+            //special note -- we allow 3 decimal places for precision. this needs enforced
+            //in the input validation of these values.
+            uint64_t percentperblock = (lock.periods[i].percent * 1000);
+            uint64_t lockamountsmaller = lock.lock_amount / 10000;
+            return ((lockamountsmaller * percentperblock) / 100000) * 10000;
+        }
+
+        //sets period_ends and unlocked_amounts from the periods of the lock, see evaluate_general_vesting.
+        static void set_general_lock_sums(eosiosystem::locked_tokens_info &lock) {
+            std::vector<int64_t> ends;
+            std::vector<uint64_t> amounts;
+            ends.reserve(lock.periods.size());
+            amounts.reserve(lock.periods.size());
+
+            uint64_t unlocked = 0;
+            for (size_t i = 0; i < lock.periods.size(); i++) {
+                ends.push_back(lock.periods[i].duration);
+                unlocked += general_lock_period_amount(lock, i);
+                amounts.push_back(unlocked);
+            }
+            std::sort(ends.begin(), ends.end());
+
+            lock.period_ends.emplace(std::move(ends));
+            lock.unlocked_amounts.emplace(std::move(amounts));
+        }
+
+        //this will compute the vesting of a general lock (locktokens) at present_time,
+        //the table is not modified.
+        static vesting_result evaluate_general_vesting(const eosiosystem::locked_tokens_info &lock,
+                                                       const uint32_t &present_time) {
+            vesting_result res;
+            res.remaining = lock.remaining_lock_amount;
+
+            if (lock.payouts_performed >= lock.periods.size()) {
+                return res;
+            }
 
-                    if (didsomething && doupdate) {
-                        //get fio balance for this account,
-                        uint32_t present_time = now();
-                        const auto my_balance = eosio::token::get_balance("fio.token"_n, actor, FIOSYMBOL.code());
-                        uint64_t amount = my_balance.amount;
-
-                        if (newlockedamount > amount) {
-                            print(" WARNING computed amount ", newlockedamount, " is more than amount in account ",
-                                  amount, " \n ",
-                                  " Transaction processing order can cause this, this amount is being re-aligned, resetting remaining locked amount to ",
-                                  amount, "\n");
-                            newlockedamount = amount;
-                        }
-                        //update the locked table.
-                        lockedTokensTable.modify(lockiter, SYSTEMACCOUNT, [&](auto &av) {
-                            av.remaining_locked_amount = newlockedamount;
-                            av.unlocked_period_count += remainingPayouts + addone;
-                        });
+            uint32_t secondsSinceGrant = (present_time - lock.timestamp);
+
+            //locks created by addgenlocked or visited by migrgenlock carry the sorted period ends
+            //and the cumulative unlocked amounts, older locks are walked period by period.
+            const bool hassums = lock.period_ends.has_value() && lock.unlocked_amounts.has_value() &&
+                                 lock.period_ends.value().size() == lock.periods.size() &&
+                                 lock.unlocked_amounts.value().size() == lock.periods.size();
+
+            uint32_t payoutsDue = 0;
+            if (hassums) {
+                const std::vector<int64_t> &ends = lock.period_ends.value();
+                payoutsDue = std::upper_bound(ends.begin(), ends.end(), (int64_t) secondsSinceGrant) - ends.begin();
+            } else {
+                for (int i = 0; i < lock.periods.size(); i++) {
+                    if (lock.periods[i].duration <= secondsSinceGrant) {
+                        payoutsDue++;
                     }
+                }
+            }
 
-                    return newlockedamount;
+            if (payoutsDue > lock.payouts_performed) {
+                uint64_t amountpay = 0;
+                if (hassums) {
+                    const std::vector<uint64_t> &unlocked = lock.unlocked_amounts.value();
+                    amountpay = unlocked[payoutsDue - 1] -
+                                (lock.payouts_performed > 0 ? unlocked[lock.payouts_performed - 1] : 0);
+                } else {
+                    for (int i = lock.payouts_performed; i < payoutsDue; i++) {
+                        amountpay += general_lock_period_amount(lock, i);
+                    }
+                }
 
+                if (res.remaining > amountpay) {
+                    res.remaining -= amountpay;
                 } else {
-                    return lockiter->remaining_locked_amount;
+                    res.remaining = 0;
                 }
+                res.payouts = payoutsDue - lock.payouts_performed;
+                res.unlocked = amountpay > 0;
             }
-            return 0;
+            return res;
         }
 
-        //begin general locked tokens
         //this will compute the present unlocked tokens for this user based on the
         //unlocking schedule, it will update the locktokens table if the doupdate
         //is set to true.
         static uint64_t computegenerallockedtokens(const name &actor, bool doupdate) {
-            uint32_t present_time = now();
-
             eosiosystem::general_locks_table generalLockTokensTable(SYSTEMACCOUNT, SYSTEMACCOUNT.value);
             auto locks_by_owner = generalLockTokensTable.get_index<"byowner"_n>();
             auto lockiter = locks_by_owner.find(actor.value);
-            if (lockiter != locks_by_owner.end()) {
+            if (lockiter == locks_by_owner.end()) {
+                return 0;
+            }
 
-                if (lockiter->payouts_performed < lockiter->periods.size()) {
-                    uint32_t secondsSinceGrant = (present_time - lockiter->timestamp);
+            if (!doupdate) {
+                return evaluate_general_vesting(*lockiter, now()).remaining;
+            }
+            return record_general_vesting(generalLockTokensTable, generalLockTokensTable.iterator_to(*lockiter), [&]() {
+                return eosio::token::get_balance("fio.token"_n, actor, FIOSYMBOL.code()).amount;
+            });
+        }
 
-                    uint32_t payoutsDue = 0;
-                    for (int i=0;i<lockiter->periods.size(); i++){
-                        if (lockiter->periods[i].duration <= secondsSinceGrant){
-                            payoutsDue++;
-                        }
+        //same as record_genesis_vesting for the general lock at lockiter in the locktokens table.
+        template<typename Balance>
+        static uint64_t record_general_vesting(eosiosystem::general_locks_table &generalLockTokensTable,
+                                               const eosiosystem::general_locks_table::const_iterator &lockiter,
+                                               const Balance &getbalance) {
+            const vesting_result vest = evaluate_general_vesting(*lockiter, now());
+            if (!vest.unlocked) {
+                return vest.remaining;
+            }
 
-                    }
-                    uint64_t amountpay = 0;
-                    uint64_t newlockedamount = lockiter->remaining_lock_amount;
-                    bool didsomething = false;
-
-                    if (payoutsDue > lockiter->payouts_performed) {
-
-                        uint64_t percentperblock = 0;
-                       for (int i=lockiter->payouts_performed; i<payoutsDue;i++){
-                           //special note -- we allow 3 decimal places for precision. this needs enforced
-                           //in the input validation of these values.
-                           percentperblock = (lockiter->periods[i].percent * 1000);
-                           uint64_t lockamountsmaller = lockiter->lock_amount / 10000;
-                           uint64_t amountadded = ((lockamountsmaller * percentperblock)/100000) * 10000;
-                           amountpay += amountadded;
-                       }
-
-                        if (newlockedamount > amountpay) {
-                            newlockedamount -= amountpay;
-                        } else {
-                            newlockedamount = 0;
-                        }
-                    }
+            const uint64_t newlockedamount = cap_locked_to_amount(getbalance(), vest.remaining);
+            //update the locked table.
+            generalLockTokensTable.modify(lockiter, SYSTEMACCOUNT, [&](auto &av) {
+                av.remaining_lock_amount = newlockedamount;
+                av.payouts_performed += vest.payouts;
+            });
+            return newlockedamount;
+        }
 
-                    if ((amountpay > 0) && doupdate) {
-                        //get fio balance for this account,
-                        uint32_t present_time = now();
-                        const auto my_balance = eosio::token::get_balance("fio.token"_n, actor, FIOSYMBOL.code());
-                        uint64_t amount = my_balance.amount;
-
-                        if (newlockedamount > amount) {
-                            print(" WARNING computed amount ", newlockedamount, " is more than amount in account ",
-                                  amount, " \n ",
-                                  " Transaction processing order can cause this, this amount is being re-aligned, resetting remaining locked amount to ",
-                                  amount, "\n");
-                            newlockedamount = amount;
-                        }
-
-                        //update the locked table.
-                        locks_by_owner.modify(lockiter, SYSTEMACCOUNT, [&](auto &av) {
-                            av.remaining_lock_amount = newlockedamount;
-                            av.payouts_performed = payoutsDue;
-                        });
-                    }
+        //this loads the balance, genesis lock and general lock of owner once for a voting power
+        //refresh. when doupdate is set the vesting of both locks is recorded first, the same way as
+        //computeremaininglockedtokens and computegenerallockedtokens do, and the rows are returned
+        //as written.
+        static eosiosystem::voting_balance get_voting_balance(const name &owner, const bool &doupdate) {
+            eosiosystem::voting_balance vb;
+            vb.balance = eosio::token::get_balance("fio.token"_n, owner, FIOSYMBOL.code()).amount;
+            const auto getbalance = [&]() { return vb.balance; };
 
-                    return newlockedamount;
+            //note -- token locks are exclusive, an account CANNOT have multiple locked token grants.
+            eosiosystem::locked_tokens_table lockedTokensTable(SYSTEMACCOUNT, SYSTEMACCOUNT.value);
+            const auto lockiter = lockedTokensTable.find(owner.value);
+            if (lockiter != lockedTokensTable.end()) {
+                if (doupdate) {
+                    record_genesis_vesting(lockedTokensTable, lockiter, getbalance);
+                }
+                vb.genesisfound = true;
+                vb.genesislock = *lockiter;
+            }
 
-                } else {
-                    return lockiter->remaining_lock_amount;
+            eosiosystem::general_locks_table generalLockTokensTable(SYSTEMACCOUNT, SYSTEMACCOUNT.value);
+            auto locks_by_owner = generalLockTokensTable.get_index<"byowner"_n>();
+            const auto glockiter = locks_by_owner.find(owner.value);
+            if (glockiter != locks_by_owner.end()) {
+                if (doupdate) {
+                    record_general_vesting(generalLockTokensTable, generalLockTokensTable.iterator_to(*glockiter),
+                                           getbalance);
                 }
+                vb.generalfound = true;
+                vb.generalcanvote = glockiter->can_vote;
+                vb.generalremaining = glockiter->remaining_lock_amount;
             }
-            return 0;
+            return vb;
         }
 
+        //the balance of an account less what its genesis and general locks hold, see get_spendable_balance.
+        struct spendable_balance {
+            uint64_t balance = 0;        //fio balance of the account.
+            uint64_t genesislocked = 0;  //amount held by the genesis lock (lockedtokens) for this spend.
+            uint64_t generallocked = 0;  //amount held by the general lock (locktokens).
+            bool feefromlocked = false;  //a fee may be paid with genesis locked tokens, reducing the lock.
+            bool lockupdate = false;     //vesting unlocked tokens, unlocktokens must record them in the lock tables.
 
+            uint64_t genesis_spendable() const { return balance > genesislocked ? balance - genesislocked : 0; }
+
+            uint64_t general_spendable() const { return balance > generallocked ? balance - generallocked : 0; }
+
+            uint64_t spendable() const { return std::min(genesis_spendable(), general_spendable()); }
+        };
+
+        //this loads the balance, genesis lock and general lock of owner once and computes their
+        //vesting once. isfee selects the rules for paying fees, fees may be paid with genesis locked
+        //tokens unless the grant is a type 2 grant older than 210 days with unlocking inhibited.
+        static spendable_balance get_spendable_balance(const name &owner, const bool &isfee) {
+            spendable_balance sb;
+            const uint32_t present_time = now();
+
+            accounts accountstable("fio.token"_n, owner.value);
+            const auto acnts_iter = accountstable.find(FIOSYMBOL.code().raw());
+            if (acnts_iter != accountstable.end()) {
+                sb.balance = acnts_iter->balance.amount;
+            }
+
+            eosiosystem::locked_tokens_table lockedTokensTable(SYSTEMACCOUNT, SYSTEMACCOUNT.value);
+            const auto lockiter = lockedTokensTable.find(owner.value);
+            if (lockiter != lockedTokensTable.end()) {
+                //TEST LOCKED TOKENS uint32_t issueplus210 = lockiter->timestamp+(25*60);
+                uint32_t issueplus210 = lockiter->timestamp + (210 * SECONDSPERDAY);
+                const bool knowngrant = (lockiter->grant_type >= 1) && (lockiter->grant_type <= 4);
+                const bool inhibited = (lockiter->grant_type == 2) &&
+                                       ((present_time > issueplus210) && lockiter->inhibit_unlocking);
+
+                if ((knowngrant && !isfee) || inhibited) {
+                    const vesting_result vest = evaluate_genesis_vesting(*lockiter, present_time);
+                    uint64_t corrected = 0;
+                    sb.genesislocked = vest.remaining;
+                    sb.lockupdate = vest.unlocked || genesis_period2_correction(*lockiter, corrected);
+                } else if (isfee) {
+                    sb.genesislocked = lockiter->remaining_locked_amount;
+                    sb.feefromlocked = true;
+                }
+            }
+
+            eosiosystem::general_locks_table generalLockTokensTable(SYSTEMACCOUNT, SYSTEMACCOUNT.value);
+            auto locks_by_owner = generalLockTokensTable.get_index<"byowner"_n>();
+            const auto glockiter = locks_by_owner.find(owner.value);
+            if (glockiter != locks_by_owner.end()) {
+                const vesting_result vest = evaluate_general_vesting(*glockiter, present_time);
+                sb.generallocked = vest.remaining;
+                sb.lockupdate = sb.lockupdate || vest.unlocked;
+            }
+            return sb;
+        }
 
     };
 } /// namespace eosio
@@ -9,6 +9,7 @@
 #define MAXFIOMINT 100000000000000000
 
 #include "fio.token/fio.token.hpp"
+#include <map>
 
 using namespace fioio;
 
@@ -105,81 +106,63 @@ namespace eosio {
         sub_balance(FIOISSUER, quantity);
     }
 
-    bool token::can_transfer(const name &tokenowner, const uint64_t &feeamount, const uint64_t &transferamount,
-                             const bool &isfee) {
-
-        //get fio balance for this account,
-        uint32_t present_time = now();
-        const auto my_balance = eosio::token::get_balance("fio.token"_n, tokenowner, FIOSYMBOL.code());
-        uint64_t amount = my_balance.amount;
-
-        //see if the user is in the lockedtokens table, if so recompute the balance
-        //based on grant type.
-        auto lockiter = lockedTokensTable.find(tokenowner.value);
-        if (lockiter != lockedTokensTable.end()) {
-            //TEST LOCKED TOKENS uint32_t issueplus210 = lockiter->timestamp+(25*60);
-            uint32_t issueplus210 = lockiter->timestamp + (210 * SECONDSPERDAY);
-
-            if (
-                //if lock type 1 or 2 or 3, 4 and not a fee subtract remaining locked amount from balance
-                    (((lockiter->grant_type == 1) || (lockiter->grant_type == 2) || (lockiter->grant_type == 3) ||
-                      (lockiter->grant_type == 4)) && !isfee) ||
-                    //if lock type 2 and more than 210 days since grant and inhibit locking is set then subtract remaining locked amount from balance .
-                    //this keeps the type 2 grant from being used for fees if the inhibit locking is not flipped after 210 days.
-                    ((lockiter->grant_type == 2) && ((present_time > issueplus210) && lockiter->inhibit_unlocking))
-                    ) {
-                //recompute the remaining locked amount based on vesting.
-                uint64_t lockedTokenAmount = computeremaininglockedtokens(tokenowner, false);//-feeamount;
-                //subtract the lock amount from the balance
-                if (lockedTokenAmount < amount) {
-                    amount -= lockedTokenAmount;
-                    return (amount >= transferamount);
-                } else {
-                    return false;
-                }
-
-            } else if (isfee) {
-
-                uint64_t unlockedbalance = 0;
-                if (amount > lockiter->remaining_locked_amount) {
-                    unlockedbalance = amount - lockiter->remaining_locked_amount;
-                }
-                if (unlockedbalance >= transferamount) {
-                    return true;
-                } else {
-                    uint64_t new_remaining_unlocked_amount =
-                            lockiter->remaining_locked_amount - (transferamount - unlockedbalance);
-                    INLINE_ACTION_SENDER(eosiosystem::system_contract, updlocked)
-                            ("eosio"_n, {{_self, "active"_n}},
-                             {tokenowner, new_remaining_unlocked_amount}
-                            );
-                    return true;
-                }
-            }
-        } else {
-            return true;
+    //returns the account of payee_public_key, the account is created and bound to the key
+    //when it does not exist yet. accountExists is set when the account was already on chain.
+    name token::bind_payee_account(const string &payee_public_key, const bool &errorifaccountexists,
+                                   bool &accountExists) {
+        string payee_account;
+        fioio::key_to_account(payee_public_key, payee_account);
+
+        name new_account_name = name(payee_account.c_str());
+        accountExists = is_account(new_account_name);
+
+        if (errorifaccountexists){
+            fio_400_assert(!(accountExists), "payee_public_key", payee_public_key,
+                           "Locked tokens can only be transferred to new account",
+                           ErrorPubKeyValid);
         }
-        //avoid compile warning.
-        return true;
+        auto other = eosionames.find(new_account_name.value);
 
-    }
+        if (other == eosionames.end()) { //the name is not in the table.
+            fio_400_assert(!accountExists, "payee_account", payee_account,
+                           "Account exists on FIO chain but is not bound in eosionames",
+                           ErrorPubAddressExist);
+
+            const auto owner_pubkey = abieos::string_to_public_key(payee_public_key);
+
+            eosiosystem::key_weight pubkey_weight = {
+                    .key = owner_pubkey,
+                    .weight = 1,
+            };
 
-    bool token::can_transfer_general(const name &tokenowner, const uint64_t &transferamount) {
-        //get fio balance for this account,
-        uint32_t present_time = now();
-        const auto my_balance = eosio::token::get_balance("fio.token"_n, tokenowner, FIOSYMBOL.code());
+            const auto owner_auth = authority{1, {pubkey_weight}, {}, {}};
 
-        uint64_t amount = my_balance.amount;
+            INLINE_ACTION_SENDER(call::eosio, newaccount)
+                    ("eosio"_n, {{_self, "active"_n}},
+                     {_self, new_account_name, owner_auth, owner_auth}
+                    );
+
+            action{
+                    permission_level{_self, "active"_n},
+                    AddressContract,
+                    "bind2eosio"_n,
+                    bind2eosio{
+                            .accountName = new_account_name,
+                            .public_key = payee_public_key,
+                            .existing = accountExists
+                    }
+            }.send();
 
-        //recompute the remaining locked amount based on vesting.
-        uint64_t lockedTokenAmount = computegenerallockedtokens(tokenowner, false);
-        //subtract the lock amount from the balance
-        if (lockedTokenAmount < amount) {
-            amount -= lockedTokenAmount;
-            return (amount >= transferamount);
         } else {
-            return false;
+            fio_400_assert(accountExists, "payee_account", payee_account,
+                           "Account does not exist on FIO chain but is bound in eosionames",
+                           ErrorPubAddressExist);
+
+            eosio_assert_message_code(payee_public_key == other->clientkey, "FIO account already bound",
+                                      fioio::ErrorPubAddressExist);
         }
+
+        return new_account_name;
     }
 
     name token::transfer_public_key(const string &payee_public_key,
@@ -211,7 +194,7 @@ namespace eosio {
         fio_400_assert(max_fee >= 0, "max_fee", to_string(max_fee), "Invalid fee value.",
                        ErrorMaxFeeInvalid);
 
-        uint128_t endpoint_hash = fioio::string_to_uint128_hash(TRANSFER_TOKENS_PUBKEY_ENDPOINT);
+        uint128_t endpoint_hash = TRANSFER_TOKENS_PUBKEY_ENDPOINT_HASH;
 
         auto fees_by_endpoint = fiofees.get_index<"byendpoint"_n>();
         auto fee_iter = fees_by_endpoint.find(endpoint_hash);
@@ -229,57 +212,8 @@ namespace eosio {
         fio_400_assert(max_fee >= reg_amount, "max_fee", to_string(max_fee), "Fee exceeds supplied maximum.",
                        ErrorMaxFeeExceeded);
 
-        string payee_account;
-        fioio::key_to_account(payee_public_key, payee_account);
-
-        name new_account_name = name(payee_account.c_str());
-        bool accountExists = is_account(new_account_name);
-
-        if (errorifaccountexists){
-            fio_400_assert(!(accountExists), "payee_public_key", payee_public_key,
-                           "Locked tokens can only be transferred to new account",
-                           ErrorPubKeyValid);
-        }
-        auto other = eosionames.find(new_account_name.value);
-
-        if (other == eosionames.end()) { //the name is not in the table.
-            fio_400_assert(!accountExists, "payee_account", payee_account,
-                           "Account exists on FIO chain but is not bound in eosionames",
-                           ErrorPubAddressExist);
-
-            const auto owner_pubkey = abieos::string_to_public_key(payee_public_key);
-
-            eosiosystem::key_weight pubkey_weight = {
-                    .key = owner_pubkey,
-                    .weight = 1,
-            };
-
-            const auto owner_auth = authority{1, {pubkey_weight}, {}, {}};
-
-            INLINE_ACTION_SENDER(call::eosio, newaccount)
-                    ("eosio"_n, {{_self, "active"_n}},
-                     {_self, new_account_name, owner_auth, owner_auth}
-                    );
-
-            action{
-                    permission_level{_self, "active"_n},
-                    AddressContract,
-                    "bind2eosio"_n,
-                    bind2eosio{
-                            .accountName = new_account_name,
-                            .public_key = payee_public_key,
-                            .existing = accountExists
-                    }
-            }.send();
-
-        } else {
-            fio_400_assert(accountExists, "payee_account", payee_account,
-                           "Account does not exist on FIO chain but is bound in eosionames",
-                           ErrorPubAddressExist);
-
-            eosio_assert_message_code(payee_public_key == other->clientkey, "FIO account already bound",
-                                      fioio::ErrorPubAddressExist);
-        }
+        bool accountExists = false;
+        const name new_account_name = bind_payee_account(payee_public_key, errorifaccountexists, accountExists);
 
         fio_fees(actor, asset{(int64_t) reg_amount, FIOSYMBOL}, TRANSFER_TOKENS_PUBKEY_ENDPOINT);
         process_rewards(tpid, reg_amount,get_self(), actor);
@@ -290,25 +224,25 @@ namespace eosio {
             require_recipient(new_account_name);
         }
 
-        INLINE_ACTION_SENDER(eosiosystem::system_contract, unlocktokens)
-                ("eosio"_n, {{_self, "active"_n}},
-                 {actor}
-                );
+        const spendable_balance sb = get_spendable_balance(actor, false);
 
-        accounts from_acnts(_self, actor.value);
-        const auto acnts_iter = from_acnts.find(FIOSYMBOL.code().raw());
-        fio_400_assert(acnts_iter != from_acnts.end(), "amount", to_string(qty.amount),
-                       "Insufficient balance",
-                       ErrorLowFunds);
-        fio_400_assert(acnts_iter->balance.amount >= qty.amount, "amount", to_string(qty.amount),
+        //only eosio may write the lock tables, have it record what vesting unlocked.
+        if (sb.lockupdate) {
+            INLINE_ACTION_SENDER(eosiosystem::system_contract, unlocktokens)
+                    ("eosio"_n, {{_self, "active"_n}},
+                     {actor}
+                    );
+        }
+
+        fio_400_assert(sb.balance >= qty.amount, "amount", to_string(qty.amount),
                        "Insufficient balance",
                        ErrorLowFunds);
 
-        fio_400_assert(can_transfer(actor, feeamount, qty.amount, false), "amount", to_string(qty.amount),
+        fio_400_assert(sb.genesis_spendable() >= qty.amount, "amount", to_string(qty.amount),
                        "Insufficient balance tokens locked",
                        ErrorInsufficientUnlockedFunds);
 
-        fio_400_assert(can_transfer_general(actor, qty.amount), "actor", to_string(actor.value),
+        fio_400_assert(sb.general_spendable() >= qty.amount, "actor", to_string(actor.value),
                        "Funds locked",
                        ErrorInsufficientUnlockedFunds);
 
@@ -361,22 +295,28 @@ namespace eosio {
         check(quantity.symbol == FIOSYMBOL, "symbol precision mismatch");
         check(memo.size() <= 256, "memo has more than 256 bytes");
 
-        accounts from_acnts(_self, from.value);
-        const auto acnts_iter = from_acnts.find(FIOSYMBOL.code().raw());
+        const spendable_balance sb = get_spendable_balance(from, true);
 
-        fio_400_assert(acnts_iter != from_acnts.end(), "max_fee", to_string(quantity.amount),
-                       "Insufficient funds to cover fee",
-                       ErrorLowFunds);
-        fio_400_assert(acnts_iter->balance.amount >= quantity.amount, "max_fee", to_string(quantity.amount),
+        fio_400_assert(sb.balance >= quantity.amount, "max_fee", to_string(quantity.amount),
                        "Insufficient funds to cover fee",
                        ErrorLowFunds);
 
         //we need to check the from, check for locked amount remaining
-        fio_400_assert(can_transfer(from, 0, quantity.amount, true), "actor", to_string(from.value),
+        const uint64_t unlockedbalance = sb.genesis_spendable();
+        if (sb.feefromlocked && unlockedbalance < quantity.amount) {
+            //pay the part of the fee the unlocked balance does not cover with locked tokens.
+            uint64_t new_remaining_unlocked_amount = sb.genesislocked - (quantity.amount - unlockedbalance);
+            INLINE_ACTION_SENDER(eosiosystem::system_contract, updlocked)
+                    ("eosio"_n, {{_self, "active"_n}},
+                     {from, new_remaining_unlocked_amount}
+                    );
+        }
+
+        fio_400_assert(sb.feefromlocked || unlockedbalance >= quantity.amount, "actor", to_string(from.value),
                        "Funds locked",
                        ErrorInsufficientUnlockedFunds);
 
-        fio_400_assert(can_transfer_general(from, quantity.amount), "actor", to_string(from.value),
+        fio_400_assert(sb.general_spendable() >= quantity.amount, "actor", to_string(from.value),
                        "Funds locked",
                        ErrorInsufficientUnlockedFunds);
 
@@ -392,7 +332,7 @@ namespace eosio {
                              const name &actor,
                              const string &tpid) {
 
-       uint128_t endpoint_hash = fioio::string_to_uint128_hash("transfer_tokens_pub_key");
+       uint128_t endpoint_hash = TRANSFER_TOKENS_PUBKEY_ENDPOINT_HASH;
 
        auto fees_by_endpoint = fiofees.get_index<"byendpoint"_n>();
        auto fee_iter = fees_by_endpoint.find(endpoint_hash);
@@ -432,6 +372,137 @@ namespace eosio {
 
     }
 
+    void token::trnsfiopubkys(const vector<transferpayee> &payees,
+                              const int64_t &max_fee,
+                              const name &actor,
+                              const string &tpid) {
+        require_auth(actor);
+
+        fio_400_assert(payees.size() >= 1 && payees.size() <= MAXTRANSFERPAYEES, "payees", "payees",
+                       "Min 1, Max 100 payees are allowed", ErrorInvalidValue);
+
+        fio_400_assert(validateTPIDFormat(tpid), "tpid", tpid,
+                       "TPID must be empty or valid FIO address",
+                       ErrorPubKeyValid);
+
+        fio_400_assert(max_fee >= 0, "max_fee", to_string(max_fee), "Invalid fee value.",
+                       ErrorMaxFeeInvalid);
+
+        auto fees_by_endpoint = fiofees.get_index<"byendpoint"_n>();
+        auto fee_iter = fees_by_endpoint.find(TRANSFER_TOKENS_PUBKEY_ENDPOINT_HASH);
+
+        fio_400_assert(fee_iter != fees_by_endpoint.end(), "endpoint_name", TRANSFER_TOKENS_PUBKEY_ENDPOINT,
+                       "FIO fee not found for endpoint", ErrorNoEndpoint);
+
+        const uint64_t fee_type = fee_iter->type;
+        fio_400_assert(fee_type == 0, "fee_type", to_string(fee_type),
+                       "transfer_tokens_pub_key unexpected fee type for endpoint transfer_tokens_pub_key, expected 0",
+                       ErrorNoEndpoint);
+
+        //one transfer_tokens_pub_key fee per payee, charged at once.
+        const uint64_t reg_amount = fee_iter->suf_amount * payees.size();
+        fio_400_assert(max_fee >= (int64_t) reg_amount, "max_fee", to_string(max_fee), "Fee exceeds supplied maximum.",
+                       ErrorMaxFeeExceeded);
+
+        asset total = asset(0, FIOSYMBOL);
+        for (const auto &payee : payees) {
+            fio_400_assert(isPubKeyValid(payee.payee_public_key), "payee_public_key", payee.payee_public_key,
+                           "Invalid FIO Public Key", ErrorPubKeyValid);
+            fio_400_assert(payee.amount > 0 && payee.amount <= asset::max_amount, "amount", std::to_string(payee.amount),
+                           "Invalid amount value", ErrorInvalidAmount);
+            total.amount += payee.amount;
+            fio_400_assert(total.is_valid(), "amount", std::to_string(payee.amount), "Invalid amount value",
+                           ErrorLowFunds);
+        }
+
+        //payee accounts, true when the account existed before this action.
+        std::map<name, bool> payeeaccounts;
+        vector<name> payeenames;
+        payeenames.reserve(payees.size());
+        for (const auto &payee : payees) {
+            string payee_account;
+            fioio::key_to_account(payee.payee_public_key, payee_account);
+            const name payeename = name(payee_account.c_str());
+
+            if (payeeaccounts.find(payeename) == payeeaccounts.end()) {
+                bool accountExists = false;
+                bind_payee_account(payee.payee_public_key, false, accountExists);
+                payeeaccounts.emplace(payeename, accountExists);
+            }
+            payeenames.push_back(payeename);
+        }
+
+        fio_fees(actor, asset{(int64_t) reg_amount, FIOSYMBOL}, TRANSFER_TOKENS_PUBKEY_ENDPOINT);
+        process_rewards(tpid, reg_amount, get_self(), actor);
+
+        require_recipient(actor);
+        for (const auto &payeeaccount : payeeaccounts) {
+            if (payeeaccount.second) {
+                require_recipient(payeeaccount.first);
+            }
+        }
+
+        const spendable_balance sb = get_spendable_balance(actor, false);
+
+        //only eosio may write the lock tables, have it record what vesting unlocked.
+        if (sb.lockupdate) {
+            INLINE_ACTION_SENDER(eosiosystem::system_contract, unlocktokens)
+                    ("eosio"_n, {{_self, "active"_n}},
+                     {actor}
+                    );
+        }
+
+        fio_400_assert(sb.balance >= total.amount, "amount", to_string(total.amount),
+                       "Insufficient balance",
+                       ErrorLowFunds);
+
+        fio_400_assert(sb.genesis_spendable() >= total.amount, "amount", to_string(total.amount),
+                       "Insufficient balance tokens locked",
+                       ErrorInsufficientUnlockedFunds);
+
+        fio_400_assert(sb.general_spendable() >= total.amount, "actor", to_string(actor.value),
+                       "Funds locked",
+                       ErrorInsufficientUnlockedFunds);
+
+        sub_balance(actor, total);
+        for (size_t i = 0; i < payees.size(); i++) {
+            add_balance(payeenames[i], asset(payees[i].amount, FIOSYMBOL), actor);
+        }
+
+        INLINE_ACTION_SENDER(eosiosystem::system_contract, updatepower)
+                ("eosio"_n, {{_self, "active"_n}},
+                 {actor, true}
+                );
+
+        for (const auto &payeeaccount : payeeaccounts) {
+            if (payeeaccount.second) {
+                INLINE_ACTION_SENDER(eosiosystem::system_contract, updatepower)
+                        ("eosio"_n, {{_self, "active"_n}},
+                         {payeeaccount.first, true}
+                        );
+            }
+        }
+
+        const uint64_t ramamount = TRANSFERPUBKEYRAM * payees.size();
+        if (ramamount > 0) {
+            action(
+                    permission_level{SYSTEMACCOUNT, "active"_n},
+                    "eosio"_n,
+                    "incram"_n,
+                    std::make_tuple(actor, ramamount)
+            ).send();
+        }
+
+        const string response_string = string("{\"status\": \"OK\",\"payees\":") +
+                                       to_string(payees.size()) + string(",\"fee_collected\":") +
+                                       to_string(reg_amount) + string("}");
+
+        fio_400_assert(transaction_size() <= MAX_TRX_SIZE, "transaction_size", std::to_string(transaction_size()),
+                       "Transaction is too large", ErrorTransactionTooLarge);
+
+        send_response(response_string.c_str());
+    }
+
     void token::trnsloctoks(const string &payee_public_key,
                              const int32_t &can_vote,
                              const vector<eosiosystem::lockperiods> periods,
@@ -464,7 +535,7 @@ namespace eosio {
         fio_400_assert(((can_vote == 0)||(can_vote == 1)), "can_vote", to_string(can_vote),
                        "Invalid can_vote value", ErrorInvalidValue);
 
-        uint128_t endpoint_hash = fioio::string_to_uint128_hash("transfer_locked_tokens");
+        uint128_t endpoint_hash = TRANSFER_LOCKED_TOKENS_ENDPOINT_HASH;
 
         auto fees_by_endpoint = fiofees.get_index<"byendpoint"_n>();
         auto fee_iter = fees_by_endpoint.find(endpoint_hash);
@@ -546,5 +617,5 @@ namespace eosio {
     }
 } /// namespace eosio
 
-EOSIO_DISPATCH( eosio::token, (create)(issue)(mintfio)(transfer)(trnsfiopubky)(trnsloctoks)
+EOSIO_DISPATCH( eosio::token, (create)(issue)(mintfio)(transfer)(trnsfiopubky)(trnsfiopubkys)(trnsloctoks)
 (retire))
@@ -340,6 +340,62 @@ public:
                 bprewdupdate(0);
         }
 
+        /*******
+         * This action performs the whole distribution of a collected fee in a single action,
+         * the foundation receives 5%, when the tpid is a registered FIO address the tpid receives 10%
+         * (plus the 40% bounty while bounty tokens remain) and the block producers 85%, otherwise
+         * the block producers receive 95%.
+         * @param actor  this is the account that paid the fee
+         * @param fee  this is the amount of the fee in SUFs
+         * @param tpid  this is the tpid of the transaction (empty when there is no tpid)
+         */
+        // @abi action
+        [[eosio::action]]
+        void feedistrib(const name &actor, const uint64_t &fee, const string &tpid) {
+
+                eosio_assert((has_auth(AddressContract) || has_auth(TokenContract) || has_auth(TREASURYACCOUNT) ||
+                             has_auth(REQOBTACCOUNT) || has_auth(SYSTEMACCOUNT) || has_auth(FeeContract)),
+                             "missing required authority of fio.address, fio.treasury, fio.fee, fio.token, eosio or fio.reqobt");
+
+                const uint64_t fdtnamount = (uint64_t)(static_cast<double>(fee) * .05);
+                fdtnrewards.set(fdtnrewards.exists() ? fdtnreward{fdtnrewards.get().rewards + fdtnamount} : fdtnreward{fdtnamount}, get_self());
+
+                bool tpidfound = false;
+                if (!tpid.empty()) {
+                        auto namesbyname = fionames.get_index<"byname"_n>();
+                        tpidfound = namesbyname.find(string_to_uint128_hash(tpid.c_str())) != namesbyname.end();
+                }
+
+                uint64_t bpamount = (uint64_t)(static_cast<double>(fee) * .95);
+                if (tpidfound) {
+                        bounties_table bounties(TPIDContract, TPIDContract.value);
+                        uint64_t bamount = 0;
+
+                        if (bounties.get().tokensminted < MAXBOUNTYTOKENSTOMINT) {
+                                bamount = (uint64_t)(static_cast<double>(fee) * .40);
+
+                                action(permission_level{get_self(), "active"_n},
+                                       TokenContract, "mintfio"_n,
+                                       make_tuple(TREASURYACCOUNT, bamount)
+                                ).send();
+
+                                action(permission_level{get_self(), "active"_n},
+                                       TPIDContract, "updatebounty"_n,
+                                       std::make_tuple(bamount)
+                                ).send();
+                        }
+
+                        action(permission_level{get_self(), "active"_n},
+                               TPIDContract, "updatetpid"_n,
+                               std::make_tuple(tpid, actor, (fee / 10) + bamount)
+                        ).send();
+
+                        bpamount = (uint64_t)(static_cast<double>(fee) * .85);
+                }
+
+                bprewards.set(bprewards.exists() ? bpreward{bprewards.get().rewards + bpamount} : bpreward{bpamount}, get_self());
+        }
+
         // @abi action
         [[eosio::action]]
         void bprewdupdate(const uint64_t &amount) {
@@ -376,5 +432,5 @@ public:
 };     //class FIOTreasury
 
 EOSIO_DISPATCH(FIOTreasury, (tpidclaim)(startclock)(bprewdupdate)(fdtnrwdupdat)(bppoolupdate)
-               (bpclaim))
+               (bpclaim)(feedistrib))
 }
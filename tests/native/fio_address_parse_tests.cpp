@@ -0,0 +1,207 @@
+/** Fio address parse native test
+ *  Description: runs parseFioAddress, and the getFioAddressStruct and validateFioNameFormat
+ *  adapters built on it, natively against the original split and validate routines, kept below
+ *  as they were before the single pass parser. random strings over the address alphabet, upper
+ *  case, invalid characters and extra '@', and random name@domain shaped addresses around the
+ *  length limits are checked: the validity and the split fields must match. the old path and
+ *  parseFioAddress are then timed on typical addresses.
+ *
+ *  @file fio_address_parse_tests.cpp
+ *  @license FIO Foundation ( https://github.com/fioprotocol/fio/blob/master/LICENSE ) Dapix
+ */
+
+#include <cctype>
+#include <random>
+#include <vector>
+#include <algorithm>
+#include <fio.common/fio_common_validator.hpp>
+#include "native_test.hpp"
+
+namespace baseline {
+    using namespace std;
+    using fioio::FioAddress;
+    using fioio::maxFioLen;
+    using fioio::maxFioDomainLen;
+    using fioio::makeLowerCase;
+
+    inline void getFioAddressStruct(const string &p, FioAddress &fa) {
+        // Split the fio name and domain portions
+        fa.fioname = "";
+        fa.fiodomain = "";
+
+        size_t pos = p.find('@');
+        fa.domainOnly = pos == 0 || pos == string::npos;
+
+        //Lower Case
+        fa.fioaddress = makeLowerCase(p);
+
+        if (pos == string::npos || fa.domainOnly) {
+            fa.fiodomain = fa.fioaddress;
+        } else {
+            fa.fioname = fa.fioaddress.substr(0, pos);
+            fa.fiodomain = fa.fioaddress.substr(pos + 1);
+        }
+    }
+
+    inline bool validateCharName(const string &name) {
+        if (name.find_first_not_of("abcdefghijklmnopqrstuvwxyz0123456789-") != std::string::npos) {
+            return false;
+        }
+        if (name.front() == '-' || name.back() == '-') {
+            return false;
+        }
+
+        return true;
+    }
+
+    inline bool validateFioNameFormat(const FioAddress &fa) {
+        if (fa.domainOnly) {
+            if (fa.fiodomain.size() < 1 || fa.fiodomain.size() > maxFioDomainLen) {
+                return false;
+            }
+            return validateCharName(fa.fiodomain);
+        } else {
+            if (fa.fioaddress.size() < 3 || fa.fioaddress.size() > maxFioLen) {
+                return false;
+            }
+            if (!validateCharName(fa.fioname) || !validateCharName(fa.fiodomain)) {
+                return false;
+            };
+        }
+
+        return true;
+    }
+}
+
+namespace {
+    using std::string;
+
+    //the original validateCharName read front() of an empty domain ("name@"), the parser rejects it.
+    bool emptyDomain(const string &p) {
+        const size_t pos = p.find('@');
+        return pos != string::npos && pos != 0 && pos == p.size() - 1;
+    }
+
+    bool expectedValid(const string &p) {
+        if (emptyDomain(p)) {
+            return false;
+        }
+        fioio::FioAddress fa;
+        baseline::getFioAddressStruct(p, fa);
+        return baseline::validateFioNameFormat(fa);
+    }
+
+    bool sameStruct(const fioio::FioAddress &a, const fioio::FioAddress &b) {
+        return a.fioaddress == b.fioaddress && a.fioname == b.fioname && a.fiodomain == b.fiodomain &&
+               a.domainOnly == b.domainOnly;
+    }
+
+    const string namechars = "abcdefghijklmnopqrstuvwxyz0123456789-";
+    const string anychars = "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789---@@ _.\x7f\x80\xe9";
+
+    string randomString(std::mt19937_64 &rng, const string &chars, const size_t &maxlen) {
+        string s(rng() % (maxlen + 1), ' ');
+        for (auto &c : s) {
+            c = chars[rng() % chars.size()];
+            if (rng() % 8 == 0) {
+                c = char(::toupper(c));
+            }
+        }
+        return s;
+    }
+}
+
+int main() {
+    std::mt19937_64 rng(20201016);
+    const uint64_t randomcases = 2000000;
+    const uint64_t shapedcases = 1000000;
+
+    uint64_t cases = 0;
+    uint64_t valid = 0;
+    uint64_t failures = 0;
+    auto compare = [&](const string &p) {
+        const bool expected = expectedValid(p);
+
+        fioio::FioAddressView view;
+        const bool parsed = fioio::parseFioAddress(p, view);
+
+        fioio::FioAddress fa;
+        fioio::getFioAddressStruct(p, fa);
+        const bool adapted = fioio::validateFioNameFormat(fa);
+
+        bool split = true;
+        if (!emptyDomain(p)) {
+            fioio::FioAddress expectedfa;
+            baseline::getFioAddressStruct(p, expectedfa);
+            split = sameStruct(expectedfa, fa);
+            if (parsed) {
+                split = split && view.fioaddress() == expectedfa.fioaddress &&
+                        view.fioname() == expectedfa.fioname && view.fiodomain() == expectedfa.fiodomain &&
+                        view.domainOnly == expectedfa.domainOnly;
+            }
+        }
+
+        cases++;
+        valid += expected;
+        if ((parsed != expected || adapted != expected || !split) && native_test::count_mismatch(failures)) {
+            printf("mismatch \"%s\": expected %d parsed %d adapted %d split %d\n", p.c_str(), expected, parsed,
+                   adapted, split);
+        }
+    };
+
+    //edge cases around the separators and the length limits.
+    for (const char *p : {"", "@", "a", "a@", "@a", "-", "a-", "-a", "a@b", "ab@c", "a@bc", "a-@b", "a@-b",
+                          "a@b-", "a@@b", "a@b@c", "A@B", "a--b@c", "a b@c", "a_b@c"}) {
+        compare(p);
+    }
+    for (size_t len = 0; len <= fioio::maxFioLen + 2; len++) {
+        compare(string(len, 'a'));
+        if (len >= 2) {
+            compare(string(len / 2, 'a') + "@" + string(len - len / 2 - 1, 'b'));
+            compare(string(len - 2, 'a') + "@b");
+            compare("a@" + string(len - 2, 'b'));
+        }
+    }
+
+    for (uint64_t i = 0; i < randomcases; i++) {
+        compare(randomString(rng, anychars, fioio::maxFioLen + 4));
+    }
+    //name@domain shaped, mostly valid characters.
+    for (uint64_t i = 0; i < shapedcases; i++) {
+        const string &chars = rng() % 16 == 0 ? anychars : namechars;
+        compare(randomString(rng, chars, 40) + "@" + randomString(rng, chars, 40));
+    }
+
+    const int status = native_test::summary("fio address parse", cases, failures);
+    printf("fio address parse: %llu valid\n", (unsigned long long) valid);
+
+    //the old validateTPIDFormat path against parseFioAddress.
+    const std::vector<string> typical = {"alice@fiotestnet", "Bob-Smith@Edge", "producer1@dapixdev", "crypto"};
+    const uint64_t rounds = 500000;
+    uint64_t checksum = 0;
+
+    const double oldns = native_test::time_ns([&] {
+        for (uint64_t r = 0; r < rounds; r++) {
+            for (const string &p : typical) {
+                fioio::FioAddress fa;
+                baseline::getFioAddressStruct(p, fa);
+                checksum += baseline::validateFioNameFormat(fa) + fa.fiodomain.size();
+            }
+        }
+    });
+
+    const double newns = native_test::time_ns([&] {
+        for (uint64_t r = 0; r < rounds; r++) {
+            for (const string &p : typical) {
+                fioio::FioAddressView fa;
+                checksum += fioio::parseFioAddress(p, fa) + fa.fiodomain().size();
+            }
+        }
+    });
+
+    const double parses = double(rounds * typical.size());
+    printf("fio address parse: getFioAddressStruct + validateFioNameFormat %.1f ns, parseFioAddress %.1f ns "
+           "per address (checksum %llu)\n", oldns / parses, newns / parses, (unsigned long long) checksum);
+
+    return status;
+}
@@ -0,0 +1,234 @@
+/** General lock vesting native test
+ *  Description: runs computegenerallockedtokens of fio.token.hpp natively against the original
+ *  computegenerallockedtokens, kept below as it was before the prefix summed periods. random
+ *  locks with 50 to 365 periods, sorted and unsorted, are evaluated with the period_ends and
+ *  unlocked_amounts set by set_general_lock_sums (binary search) and without them (the per
+ *  period walk), at random times and at both sides of period ends, with doupdate on and off and
+ *  balances below the computed lock. the returned amount, the lock row written back and any
+ *  abort must match. evaluate_general_vesting is then timed on both paths.
+ *
+ *  @file general_vesting_tests.cpp
+ *  @license FIO Foundation ( https://github.com/fioprotocol/fio/blob/master/LICENSE ) Dapix
+ */
+
+#include <random>
+#include <fio.token/fio.token.hpp>
+#include "native_test.hpp"
+
+namespace baseline {
+    using namespace eosio;
+    using namespace fioio;
+
+    //this will compute the present unlocked tokens for this user based on the
+    //unlocking schedule, it will update the locktokens table if the doupdate
+    //is set to true.
+    inline uint64_t computegenerallockedtokens(const name &actor, bool doupdate) {
+        uint32_t present_time = now();
+
+        eosiosystem::general_locks_table generalLockTokensTable(SYSTEMACCOUNT, SYSTEMACCOUNT.value);
+        auto locks_by_owner = generalLockTokensTable.get_index<"byowner"_n>();
+        auto lockiter = locks_by_owner.find(actor.value);
+        if (lockiter != locks_by_owner.end()) {
+
+            if (lockiter->payouts_performed < lockiter->periods.size()) {
+                uint32_t secondsSinceGrant = (present_time - lockiter->timestamp);
+
+                uint32_t payoutsDue = 0;
+                for (int i=0;i<lockiter->periods.size(); i++){
+                    if (lockiter->periods[i].duration <= secondsSinceGrant){
+                        payoutsDue++;
+                    }
+
+                }
+                uint64_t amountpay = 0;
+                uint64_t newlockedamount = lockiter->remaining_lock_amount;
+                bool didsomething = false;
+
+                if (payoutsDue > lockiter->payouts_performed) {
+
+                    uint64_t percentperblock = 0;
+                   for (int i=lockiter->payouts_performed; i<payoutsDue;i++){
+                       //special note -- we allow 3 decimal places for precision. this needs enforced
+                       //in the input validation of these values.
+                       percentperblock = (lockiter->periods[i].percent * 1000);
+                       uint64_t lockamountsmaller = lockiter->lock_amount / 10000;
+                       uint64_t amountadded = ((lockamountsmaller * percentperblock)/100000) * 10000;
+                       amountpay += amountadded;
+                   }
+
+                    if (newlockedamount > amountpay) {
+                        newlockedamount -= amountpay;
+                    } else {
+                        newlockedamount = 0;
+                    }
+                }
+
+                if ((amountpay > 0) && doupdate) {
+                    //get fio balance for this account,
+                    uint32_t present_time = now();
+                    const auto my_balance = eosio::token::get_balance("fio.token"_n, actor, FIOSYMBOL.code());
+                    uint64_t amount = my_balance.amount;
+
+                    if (newlockedamount > amount) {
+                        print(" WARNING computed amount ", newlockedamount, " is more than amount in account ",
+                              amount, " \n ",
+                              " Transaction processing order can cause this, this amount is being re-aligned, resetting remaining locked amount to ",
+                              amount, "\n");
+                        newlockedamount = amount;
+                    }
+
+                    //update the locked table.
+                    locks_by_owner.modify(lockiter, SYSTEMACCOUNT, [&](auto &av) {
+                        av.remaining_lock_amount = newlockedamount;
+                        av.payouts_performed = payoutsDue;
+                    });
+                }
+
+                return newlockedamount;
+
+            } else {
+                return lockiter->remaining_lock_amount;
+            }
+        }
+        return 0;
+    }
+}
+
+namespace {
+    using eosiosystem::locked_tokens_info;
+    using eosiosystem::lockperiods;
+    using outcome = native_test::outcome<locked_tokens_info>;
+
+    const eosio::name ACTOR = eosio::name("general1");
+
+    bool same(const outcome &a, const outcome &b) {
+        return native_test::same(a, b, [](const locked_tokens_info &x, const locked_tokens_info &y) {
+            return x.remaining_lock_amount == y.remaining_lock_amount && x.payouts_performed == y.payouts_performed;
+        });
+    }
+
+    //a lock of periods periods whose percents, in thousandths, add up to 100.
+    locked_tokens_info random_lock(std::mt19937_64 &rng, const uint32_t &periods, const bool &sorted,
+                                   const uint32_t &granted) {
+        locked_tokens_info lock;
+        lock.id = 0;
+        lock.owner_account = ACTOR;
+        lock.lock_amount = (int64_t) (rng() % 1000000000000000000ULL);
+        lock.can_vote = 0;
+        lock.timestamp = granted;
+
+        std::vector<uint64_t> shares(periods, 1);
+        for (uint64_t left = 100000 - periods; left > 0; left--) {
+            shares[rng() % periods]++;
+        }
+        int64_t duration = 0;
+        for (uint32_t i = 0; i < periods; i++) {
+            //durations repeat now and then.
+            duration += rng() % 8 == 0 ? 0 : 1 + rng() % (2 * SECONDSPERDAY);
+            lock.periods.push_back(lockperiods{duration, shares[i] / 1000.0});
+        }
+        if (!sorted) {
+            std::shuffle(lock.periods.begin(), lock.periods.end(), rng);
+        }
+
+        lock.payouts_performed = rng() % 4 == 0 ? 0 : (int32_t) (rng() % (periods + 1));
+        uint64_t unlocked = 0;
+        for (int32_t i = 0; i < lock.payouts_performed; i++) {
+            unlocked += eosio::token::general_lock_period_amount(lock, i);
+        }
+        lock.remaining_lock_amount = lock.lock_amount > unlocked ? lock.lock_amount - unlocked : 0;
+        return lock;
+    }
+}
+
+int main() {
+    std::mt19937_64 rng(20201016);
+    const uint32_t granted = 1600000000;
+    const uint32_t lockcount = 4000;
+    const uint32_t timesperlock = 25;
+
+    uint64_t cases = 0;
+    uint64_t failures = 0;
+    eosiosystem::general_locks_table locks(fioio::SYSTEMACCOUNT, fioio::SYSTEMACCOUNT.value);
+    std::vector<locked_tokens_info> summed;
+    std::vector<locked_tokens_info> walked;
+    std::vector<uint32_t> times;
+
+    for (uint32_t l = 0; l < lockcount; l++) {
+        const uint32_t periods = 50 + rng() % 316;
+        const bool sorted = l % 2 == 0;
+        const locked_tokens_info walk = random_lock(rng, periods, sorted, granted);
+        locked_tokens_info sums = walk;
+        eosio::token::set_general_lock_sums(sums);
+
+        const int64_t lastend = walk.periods.empty() ? 0 : std::max_element(walk.periods.begin(), walk.periods.end(),
+                [](const lockperiods &a, const lockperiods &b) { return a.duration < b.duration; })->duration;
+
+        for (uint32_t t = 0; t < timesperlock; t++) {
+            uint32_t present_time = 0;
+            if (t == 0) {
+                //a clock behind the grant time.
+                present_time = granted - 1 - rng() % SECONDSPERDAY;
+            } else if (t % 3 == 0) {
+                //either side of a period end.
+                present_time = granted + walk.periods[rng() % periods].duration - (t % 2);
+            } else {
+                present_time = granted + rng() % (lastend + SECONDSPERDAY);
+            }
+
+            //a balance covering the lock and one below it, which clamps the lock.
+            const int64_t balance = rng() % 2 ? walk.lock_amount : walk.remaining_lock_amount / 3;
+            eosio::native::balances[ACTOR.value] = balance;
+            eosio::native::present_time = present_time;
+
+            for (const bool doupdate : {false, true}) {
+                const outcome expected = native_test::run(locks, walk, ACTOR, doupdate,
+                                                          baseline::computegenerallockedtokens);
+                const outcome actualwalk = native_test::run(locks, walk, ACTOR, doupdate,
+                                                            eosio::token::computegenerallockedtokens);
+                const outcome actualsums = native_test::run(locks, sums, ACTOR, doupdate,
+                                                            eosio::token::computegenerallockedtokens);
+                cases += 2;
+                if ((!same(expected, actualwalk) || !same(expected, actualsums)) &&
+                    native_test::count_mismatch(failures)) {
+                    printf("mismatch periods %u sorted %d performed %d amount %lld balance %lld seconds %lld "
+                           "doupdate %d: expected %llu/%lld/%d walk %llu/%lld/%d sums %llu/%lld/%d\n",
+                           periods, sorted, walk.payouts_performed, (long long) walk.lock_amount,
+                           (long long) balance, (long long) present_time - (long long) granted, doupdate,
+                           (unsigned long long) expected.returned, (long long) expected.row.remaining_lock_amount, expected.row.payouts_performed,
+                           (unsigned long long) actualwalk.returned, (long long) actualwalk.row.remaining_lock_amount,
+                           actualwalk.row.payouts_performed,
+                           (unsigned long long) actualsums.returned, (long long) actualsums.row.remaining_lock_amount,
+                           actualsums.row.payouts_performed);
+                }
+            }
+            times.push_back(present_time);
+        }
+        summed.push_back(sums);
+        walked.push_back(walk);
+    }
+
+    const int status = native_test::summary("general vesting", cases, failures);
+
+    //evaluate_general_vesting with the prefix sums against the per period walk.
+    auto time = [&](const std::vector<locked_tokens_info> &evaluated, uint64_t &checksum) {
+        return native_test::time_ns([&] {
+            for (uint32_t round = 0; round < 10; round++) {
+                for (size_t i = 0; i < times.size(); i++) {
+                    checksum += eosio::token::evaluate_general_vesting(evaluated[i / timesperlock],
+                                                                       times[i]).remaining;
+                }
+            }
+        });
+    };
+
+    uint64_t walkchecksum = 0;
+    uint64_t sumschecksum = 0;
+    const double walkns = time(walked, walkchecksum);
+    const double sumsns = time(summed, sumschecksum);
+    const double evaluations = 10.0 * times.size();
+    printf("general vesting: per period walk %.1f ns, prefix sums %.1f ns per evaluation (checksums %s)\n",
+           walkns / evaluations, sumsns / evaluations, walkchecksum == sumschecksum ? "match" : "differ");
+
+    return status == 0 && walkchecksum == sumschecksum ? 0 : 1;
+}
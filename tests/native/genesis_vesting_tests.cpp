@@ -0,0 +1,318 @@
+/** Genesis lock vesting native test
+ *  Description: runs the genesis lock routines of fio.token.hpp (evaluate_genesis_vesting,
+ *  genesis_period2_correction, cap_locked_to_amount through computeremaininglockedtokens)
+ *  natively against the original computeremaininglockedtokens, kept below as it was before the
+ *  per grant type schedule. every grant type, inhibit flag and unlocked period count is run over
+ *  every day of the vesting schedule, with doupdate on and off, lock rows that need the period 2
+ *  correction and balances below the computed lock. the returned amount, the lock row written
+ *  back and any abort must match. get_voting_balance, which records the same vesting for voting
+ *  power, must write the same row and return it, and leave the row as is without doupdate.
+ *
+ *  @file genesis_vesting_tests.cpp
+ *  @license FIO Foundation ( https://github.com/fioprotocol/fio/blob/master/LICENSE ) Dapix
+ */
+
+#include <fio.token/fio.token.hpp>
+#include "native_test.hpp"
+
+namespace baseline {
+    using namespace eosio;
+    using namespace fioio;
+
+    //this will compute the present unlocked tokens for this user based on the
+    //unlocking schedule, it will update the lockedtokens table if the doupdate
+    //is set to true.
+    inline uint64_t computeremaininglockedtokens(const name &actor, bool doupdate) {
+        uint32_t present_time = now();
+
+        eosiosystem::locked_tokens_table lockedTokensTable(SYSTEMACCOUNT, SYSTEMACCOUNT.value);
+        auto lockiter = lockedTokensTable.find(actor.value);
+        if (lockiter != lockedTokensTable.end()) {
+            if (lockiter->inhibit_unlocking && (lockiter->grant_type == 2)) {
+                return lockiter->remaining_locked_amount;
+            }
+            if (lockiter->unlocked_period_count < 6) {
+                //to shorten the vesting schedule adapt these variables.
+                uint32_t daysSinceGrant = (int) ((present_time - lockiter->timestamp) / SECONDSPERDAY);
+                uint32_t firstPayPeriod = 90;
+                uint32_t payoutTimePeriod = 180;
+
+                //TEST LOCKED TOKENS uint32_t daysSinceGrant =  (int)((present_time  - lockiter->timestamp) / 60);
+                //TEST LOCKED TOKENS uint32_t firstPayPeriod = 15;
+                //TEST LOCKED TOKENS uint32_t payoutTimePeriod = 15;
+
+                bool ninetyDaysSinceGrant = daysSinceGrant >= firstPayPeriod;
+
+                uint64_t payoutsDue = 0;
+                if (daysSinceGrant > firstPayPeriod) {
+                    daysSinceGrant -= firstPayPeriod;
+                    payoutsDue = daysSinceGrant / payoutTimePeriod;
+                    if (payoutsDue > 6) {
+                        payoutsDue = 6;
+                    }
+                }
+
+                uint64_t numberVestingPayouts = lockiter->unlocked_period_count;
+                uint64_t remainingPayouts = 0;
+                uint64_t newlockedamount = lockiter->remaining_locked_amount;
+                uint64_t totalgrantamount = lockiter->total_grant_amount;
+                uint64_t amountpay = 0;
+                uint64_t addone = 0;
+                bool didsomething = false;
+
+
+                //this logic corrects the locked token accounting for accounts suffering from the bug
+                //discovered in the second period unlocking.
+
+                // verify the unlock_period_count_against the remaining_locked_amount, correct
+                //it if necessary,
+                //NOTE -- this distinct logic block is placed purposefully,
+                // there is duplicate code here, and local vars, the intention is to
+                // ensure there are NO side effects to other logical sections of this code.
+                //the intention is to ensure that the logic used to calculate the unlock is
+                //exactly the same as that used during the unlock.
+                //the performance implications of this new code is that this code will run for every
+                //vote, proxy, or transfer during the second unlocking period, if an account is mis-accounted
+                //it will run all of the logic to resolve the accounting. if an account is not mis-accounted
+                // the overhead is about 6 extra computations being performed during unlock period 2
+                // for all transfers votes and proxys.
+                if ((numberVestingPayouts == 2)&&
+                    ((lockiter->grant_type == 1) ||
+                     (lockiter->grant_type == 2) ||
+                     (lockiter->grant_type == 3)) && doupdate)
+                {
+                    //we will compute the total we should have unlocked in this period.
+                    //if the amount is greater than what has been unlocked so far we will
+                    //correct the amount to be unlocked.
+                    uint64_t totalunlock = 0;
+                    uint64_t nremaininglocked = 0;
+                    //compute the first unlock the same way as it was computed during unlock.
+                    totalunlock = (totalgrantamount / 100) * 6;
+                    //apply the new logic to reduce the size of the calculations for the remaining percent.
+                    //do this in the same way as it was performed in the unlock.
+                    uint64_t totalgrantsmaller = totalgrantamount / 10000;
+                    // compute the amount that should have been unlocked in the
+                    // second unlock period.
+                    totalunlock += ((( (totalgrantsmaller * 18800)) / 100000) * 10000);
+                    if (totalgrantamount >= totalunlock) {
+                        nremaininglocked = (totalgrantamount - totalunlock);
+                    }
+                    else {
+                        //if this went neg for some reason, just leave the lock amount as it is.
+                        return lockiter->remaining_locked_amount;
+                    }
+
+                    //if the computed remaining locked amount for period 2 is less than the present
+                    //remaining locked amount then set the new value using the same logic that
+                    //was used during the unlock period.
+                    if (nremaininglocked < newlockedamount) {
+                        const auto my_balance = eosio::token::get_balance("fio.token"_n, actor,
+                                                                          FIOSYMBOL.code());
+                        uint64_t amount = my_balance.amount;
+
+                        if (nremaininglocked > amount) {
+                            print(" WARNING computed amount ", nremaininglocked,
+                                  " is more than amount in account ",
+                                  amount, " \n ",
+                                  " Transaction processing order can cause this, this amount is being re-aligned, resetting remaining locked amount to ",
+                                  amount, "\n");
+                            nremaininglocked = amount;
+                        }
+
+                        lockedTokensTable.modify(lockiter, SYSTEMACCOUNT, [&](auto &av) {
+                            av.remaining_locked_amount = nremaininglocked;
+                        });
+                    }
+                }
+
+                //process the first unlock period.
+                if ((numberVestingPayouts == 0) && (ninetyDaysSinceGrant)) {
+                    if ((lockiter->grant_type == 1) ||
+                        (lockiter->grant_type == 2) ||
+                        (lockiter->grant_type == 3)) {
+                        //pay out 1% for type 1
+                        amountpay = (totalgrantamount / 100) * 6;
+                    } else if (lockiter->grant_type == 4) {
+                        //pay out 0 for type 4
+                        amountpay = 0;
+                    } else {
+                        check(false, "unknown grant type");
+                    }
+
+                    if (newlockedamount > amountpay) {
+                        newlockedamount -= amountpay;
+                    } else {
+                        newlockedamount = 0;
+                    }
+                    addone = 1;
+                    didsomething = true;
+                }
+
+                //this accounts for the first unlocking period being the day 0 unlocking period.
+                if (numberVestingPayouts > 0) {
+                    numberVestingPayouts--;
+                }
+
+                //process the rest of the payout periods, other than the first period.
+                if (payoutsDue > numberVestingPayouts) {
+                    remainingPayouts = payoutsDue - numberVestingPayouts;
+                    uint64_t percentperblock = 0;
+                    if ((lockiter->grant_type == 1) ||
+                        (lockiter->grant_type == 2) ||
+                        (lockiter->grant_type == 3)) {
+                        //this logic assumes to have 3 decimal places in the specified percentage
+                        percentperblock = 18800;
+                    } else if (lockiter->grant_type == 4) {
+                        //this is assumed to have 3 decimal places in the specified percentage
+                        return lockiter->remaining_locked_amount;
+                    } else {  //unknown lock type, dont unlock
+                        return lockiter->remaining_locked_amount;
+                    }
+
+                    //we eliminate the last 5 digits of the SUFs to avoid overflow in the calculations
+                    //that follow.
+                    uint64_t totalgrantsmaller = totalgrantamount/10000;
+                    amountpay = ((remainingPayouts * (totalgrantsmaller * percentperblock)) / 100000) * 10000;
+
+                    if (newlockedamount > amountpay) {
+                        newlockedamount -= amountpay;
+                    } else {
+                        newlockedamount = 0;
+                    }
+                    didsomething = true;
+                }
+
+                if (didsomething && doupdate) {
+                    //get fio balance for this account,
+                    uint32_t present_time = now();
+                    const auto my_balance = eosio::token::get_balance("fio.token"_n, actor, FIOSYMBOL.code());
+                    uint64_t amount = my_balance.amount;
+
+                    if (newlockedamount > amount) {
+                        print(" WARNING computed amount ", newlockedamount, " is more than amount in account ",
+                              amount, " \n ",
+                              " Transaction processing order can cause this, this amount is being re-aligned, resetting remaining locked amount to ",
+                              amount, "\n");
+                        newlockedamount = amount;
+                    }
+                    //update the locked table.
+                    lockedTokensTable.modify(lockiter, SYSTEMACCOUNT, [&](auto &av) {
+                        av.remaining_locked_amount = newlockedamount;
+                        av.unlocked_period_count += remainingPayouts + addone;
+                    });
+                }
+
+                return newlockedamount;
+
+            } else {
+                return lockiter->remaining_locked_amount;
+            }
+        }
+        return 0;
+    }
+}
+
+namespace {
+    using eosiosystem::locked_token_holder_info;
+    using outcome = native_test::outcome<locked_token_holder_info>;
+
+    const eosio::name ACTOR = eosio::name("genesis1");
+
+    bool same(const outcome &a, const outcome &b) {
+        return native_test::same(a, b, [](const locked_token_holder_info &x, const locked_token_holder_info &y) {
+            return x.remaining_locked_amount == y.remaining_locked_amount &&
+                   x.unlocked_period_count == y.unlocked_period_count;
+        });
+    }
+}
+
+int main() {
+    const uint32_t granted = 1600000000;
+    const uint64_t grants[] = {0, 1, 9999, 10001, 123456789, 1000000000000000ULL, 987654321098765432ULL};
+    //seconds into the day, the day count is taken at both ends of each day.
+    const uint32_t dayoffsets[] = {0, SECONDSPERDAY - 1};
+    //days past the last payout period (90 + 6 * 180) are covered by the tail of the sweep.
+    const uint32_t lastday = 1300;
+
+    uint64_t cases = 0;
+    uint64_t failures = 0;
+    eosiosystem::locked_tokens_table locks(fioio::SYSTEMACCOUNT, fioio::SYSTEMACCOUNT.value);
+    auto compare = [&](const locked_token_holder_info &lock, const uint32_t &present_time) {
+        eosio::native::present_time = present_time;
+        for (const bool doupdate : {false, true}) {
+            const outcome expected = native_test::run(locks, lock, ACTOR, doupdate,
+                                                      baseline::computeremaininglockedtokens);
+            const outcome actual = native_test::run(locks, lock, ACTOR, doupdate,
+                                                    eosio::token::computeremaininglockedtokens);
+            //get_voting_balance records the same vesting when voting and hands back the row it wrote,
+            //otherwise it reads the row as stored, like the votable balance did before.
+            bool votedsame = true;
+            const outcome voted = native_test::run(locks, lock, ACTOR, doupdate,
+                                                   [&](const eosio::name &actor, bool update) -> uint64_t {
+                const eosiosystem::voting_balance vb = eosio::token::get_voting_balance(actor, update);
+                const locked_token_holder_info &row = locks.get(actor.value);
+                votedsame = vb.genesisfound && vb.genesislock.remaining_locked_amount == row.remaining_locked_amount &&
+                            vb.genesislock.unlocked_period_count == row.unlocked_period_count;
+                return expected.returned;
+            });
+            cases++;
+            const bool votedok = votedsame && (doupdate ? same(expected, voted) :
+                                               !voted.aborted && voted.row.remaining_locked_amount == lock.remaining_locked_amount &&
+                                               voted.row.unlocked_period_count == lock.unlocked_period_count);
+            if ((!same(expected, actual) || !votedok) && native_test::count_mismatch(failures)) {
+                printf("mismatch grant_type %u inhibit %u periods %u grant %llu remaining %llu balance %lld "
+                       "day %lld doupdate %d: expected %llu/%llu/%u%s actual %llu/%llu/%u%s\n",
+                       lock.grant_type, lock.inhibit_unlocking, lock.unlocked_period_count,
+                       (unsigned long long) lock.total_grant_amount,
+                       (unsigned long long) lock.remaining_locked_amount,
+                       (long long) eosio::native::balances[ACTOR.value],
+                       ((long long) present_time - (long long) lock.timestamp) / SECONDSPERDAY, doupdate,
+                       (unsigned long long) expected.returned,
+                       (unsigned long long) expected.row.remaining_locked_amount,
+                       expected.row.unlocked_period_count, expected.aborted ? " aborted" : "",
+                       (unsigned long long) actual.returned,
+                       (unsigned long long) actual.row.remaining_locked_amount,
+                       actual.row.unlocked_period_count, actual.aborted ? " aborted" : "");
+            }
+        }
+    };
+
+    for (uint32_t grant_type = 0; grant_type <= 5; grant_type++) {
+        for (uint32_t inhibit = 0; inhibit <= 1; inhibit++) {
+            for (uint32_t periods = 0; periods <= 7; periods++) {
+                for (const uint64_t grant : grants) {
+                    //the full grant, a row short of the period 2 correction and a row the correction lowers.
+                    const uint64_t remainings[] = {grant, grant / 3, grant - grant / 10};
+                    for (const uint64_t remaining : remainings) {
+                        //a balance covering the lock and one below it, which clamps the lock.
+                        const int64_t balances[] = {(int64_t) (grant / 2 + remaining / 2 + 1), (int64_t) (remaining / 2)};
+                        for (const int64_t balance : balances) {
+                            eosio::native::balances[ACTOR.value] = balance;
+
+                            locked_token_holder_info lock;
+                            lock.owner = ACTOR;
+                            lock.total_grant_amount = grant;
+                            lock.unlocked_period_count = periods;
+                            lock.grant_type = grant_type;
+                            lock.inhibit_unlocking = inhibit;
+                            lock.remaining_locked_amount = remaining;
+                            lock.timestamp = granted;
+
+                            for (uint32_t day = 0; day <= lastday; day++) {
+                                for (const uint32_t offset : dayoffsets) {
+                                    compare(lock, granted + day * SECONDSPERDAY + offset);
+                                }
+                            }
+                            //clocks behind the grant time.
+                            for (const uint32_t behind : {1U, (uint32_t) SECONDSPERDAY, 400U * SECONDSPERDAY}) {
+                                compare(lock, granted - behind);
+                            }
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    return native_test::summary("genesis vesting", cases, failures);
+}
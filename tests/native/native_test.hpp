@@ -0,0 +1,77 @@
+/** Native test harness
+ *  Description: the helpers shared by the native tests. each test runs a contract routine natively
+ *  against a copy of the original routine kept in its baseline namespace, counts the mismatches
+ *  and times both. the tests are built and run by the top level build (BUILD_NATIVE_TESTS), or
+ *  alone from the repository root:
+ *    cmake -S tests/native -B build_native && cmake --build build_native && ctest --test-dir build_native
+ *  @file native_test.hpp
+ *  @license FIO Foundation ( https://github.com/fioprotocol/fio/blob/master/LICENSE ) Dapix
+ */
+
+#pragma once
+
+#include <cstdio>
+#include <cstdint>
+#include <chrono>
+#include <native_eosio.hpp>
+
+namespace native_test {
+
+    //mismatches printed before the rest are only counted.
+    constexpr uint64_t MAXPRINTED = 10;
+
+    //counts a mismatch, true while it should still be printed.
+    inline bool count_mismatch(uint64_t &failures) {
+        return failures++ < MAXPRINTED;
+    }
+
+    //prints the case count of a test, returns the exit status.
+    inline int summary(const char *test, const uint64_t &cases, const uint64_t &failures) {
+        printf("%s: %llu cases, %llu mismatches\n", test, (unsigned long long) cases,
+               (unsigned long long) failures);
+        return failures == 0 ? 0 : 1;
+    }
+
+    //nanoseconds taken by body.
+    template<typename Body>
+    double time_ns(Body &&body) {
+        const auto started = std::chrono::steady_clock::now();
+        body();
+        return (double) std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now() - started).count();
+    }
+
+    //what running a lock routine left: any abort, the amount returned and the lock row.
+    template<typename Row>
+    struct outcome {
+        bool aborted = false;
+        uint64_t returned = 0;
+        Row row;
+    };
+
+    //stores lock in locks, replacing the row with its id, runs compute(actor, doupdate) and reads
+    //the row back.
+    template<typename Table, typename Row, typename Compute>
+    outcome<Row> run(Table &locks, const Row &lock, const eosio::name &actor, const bool &doupdate,
+                     Compute &&compute) {
+        outcome<Row> res;
+        locks.emplace(actor, [&](auto &row) { row = lock; });
+        try {
+            res.returned = compute(actor, doupdate);
+        } catch (const eosio::check_failure &) {
+            res.aborted = true;
+        }
+        res.row = locks.get(lock.primary_key());
+        return res;
+    }
+
+    //two runs agree when both aborted, or neither did and they returned the same amount and left
+    //rows that sameRow finds equal.
+    template<typename Row, typename SameRow>
+    bool same(const outcome<Row> &a, const outcome<Row> &b, SameRow &&sameRow) {
+        if (a.aborted || b.aborted) {
+            return a.aborted == b.aborted;
+        }
+        return a.returned == b.returned && sameRow(a.row, b.row);
+    }
+}
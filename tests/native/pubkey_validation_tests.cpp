@@ -0,0 +1,334 @@
+/** Public key validation native test
+ *  Description: runs decode_pubkey of keyops.hpp, as isPubKeyValid and through key_to_account, natively
+ *  against the original isPubKeyValid and key_to_account, kept below as they were before the fixed
+ *  size decoder. random 37 byte values with 0 to 3 leading zero bytes and head bytes around the
+ *  largest that fits 50 base58 digits are encoded with a correct checksum, both canonically and
+ *  left padded with '1's, then mutated: a changed digit, a wrong prefix or length, characters
+ *  outside the alphabet. the validity and the account derived from valid keys must match. the old
+ *  check and decode_pubkey are then timed on valid keys.
+ *
+ *  @file pubkey_validation_tests.cpp
+ *  @license FIO Foundation ( https://github.com/fioprotocol/fio/blob/master/LICENSE ) Dapix
+ */
+
+#include <cctype>
+#include <random>
+#include <native_eosio.hpp>
+#include <fio.common/keyops.hpp>
+#include "native_test.hpp"
+
+namespace baseline {
+    using namespace std;
+    using namespace eosio;
+
+    static const int8_t mapBase58[256] = {
+            -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+            -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+            -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+            -1, 0, 1, 2, 3, 4, 5, 6, 7, 8, -1, -1, -1, -1, -1, -1,
+            -1, 9, 10, 11, 12, 13, 14, 15, 16, -1, 17, 18, 19, 20, 21, -1,
+            22, 23, 24, 25, 26, 27, 28, 29, 30, 31, 32, -1, -1, -1, -1, -1,
+            -1, 33, 34, 35, 36, 37, 38, 39, 40, 41, 42, 43, -1, 44, 45, 46,
+            47, 48, 49, 50, 51, 52, 53, 54, 55, 56, 57, -1, -1, -1, -1, -1,
+            -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+            -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+            -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+            -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+            -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+            -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+            -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+            -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    };
+
+    bool DecodeBase58(const char *psz, std::vector<unsigned char> &vch) {
+        // Skip leading spaces.
+        while (*psz && isspace(*psz))
+            psz++;
+        // Skip and count leading '1's.
+        int zeroes = 0;
+        int length = 0;
+        while (*psz == '1') {
+            zeroes++;
+            psz++;
+        }
+        // Allocate enough space in big-endian base256 representation.
+        int size = strlen(psz) * 733 / 1000 + 1; // log(58) / log(256), rounded up.
+        std::vector<unsigned char> b256(size);
+        // Process the characters.
+        static_assert(sizeof(mapBase58) / sizeof(mapBase58[0]) == 256,
+                      "mapBase58.size() should be 256"); // guarantee not out of range
+        while (*psz && !isspace(*psz)) {
+            // Decode base58 character
+            int carry = mapBase58[(uint8_t) * psz];
+            if (carry == -1)  // Invalid b58 character
+                return false;
+            int i = 0;
+            for (std::vector<unsigned char>::reverse_iterator it = b256.rbegin();
+                 (carry != 0 || i < length) && (it != b256.rend()); ++it, ++i) {
+                carry += 58 * (*it);
+                *it = carry % 256;
+                carry /= 256;
+            }
+            assert(carry == 0);
+            length = i;
+            psz++;
+        }
+        // Skip trailing spaces.
+        while (isspace(*psz))
+            psz++;
+        if (*psz != 0)
+            return false;
+        // Skip leading zeroes in b256.
+        std::vector<unsigned char>::iterator it = b256.begin() + (size - length);
+        while (it != b256.end() && *it == 0)
+            it++;
+        // Copy result into output vector.
+        vch.reserve(zeroes + (b256.end() - it));
+        vch.assign(zeroes, 0x00);
+        while (it != b256.end())
+            vch.push_back(*(it++));
+        return true;
+    }
+
+    bool decode_base58(const string &str, vector<unsigned char> &vch) {
+        return DecodeBase58(str.c_str(), vch);
+    }
+
+    inline bool isPubKeyValid(const string &pubkey) {
+
+        if (pubkey.length() != 53) return false;
+
+        string pubkey_prefix("FIO");
+        auto result = mismatch(pubkey_prefix.begin(), pubkey_prefix.end(),
+                               pubkey.begin());
+        if (result.first != pubkey_prefix.end()) return false;
+        auto base58substr = pubkey.substr(pubkey_prefix.length());
+
+        vector<unsigned char> vch;
+        if (!decode_base58(base58substr, vch) || (vch.size() != 37)) return false;
+
+        array<unsigned char, 33> pubkey_data;
+        copy_n(vch.begin(), 33, pubkey_data.begin());
+
+        capi_checksum160 check_pubkey;
+        ripemd160(reinterpret_cast<char *>(pubkey_data.data()), 33, &check_pubkey);
+        if (memcmp(&check_pubkey.hash, &vch.end()[-4], 4) != 0) return false;
+        //end of the public key validity check.
+
+        return true;
+    }
+
+    const char ALPHABET_MAP[128] = {
+            -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+            -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+            -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+            -1, 0, 1, 2, 3, 4, 5, 6, 7, 8, -1, -1, -1, -1, -1, -1,
+            -1, 9, 10, 11, 12, 13, 14, 15, 16, -1, 17, 18, 19, 20, 21, -1,
+            22, 23, 24, 25, 26, 27, 28, 29, 30, 31, 32, -1, -1, -1, -1, -1,
+            -1, 33, 34, 35, 36, 37, 38, 39, 40, 41, 42, 43, -1, 44, 45, 46,
+            47, 48, 49, 50, 51, 52, 53, 54, 55, 56, 57, -1, -1, -1, -1, -1
+    };
+
+// result must be declared (for the worst case): char result[len * 2];
+    static int DecodeBase58(
+            const char *str, int len, unsigned char *result) {
+        int resultlen = 1;
+        if( str != nullptr ){
+            result[0] = 0;
+            for (int i = 0; i < len; i++) {
+                unsigned int carry = (unsigned int) ALPHABET_MAP[(unsigned char) str[i]];
+                for (int j = 0; j < resultlen; j++) {
+                    carry += (unsigned int) (result[j]) * 58;
+                    result[j] = (unsigned char) (carry & 0xff);
+                    carry >>= 8;
+                }
+                while (carry > 0) {
+                    result[resultlen++] = (unsigned int) (carry & 0xff);
+                    carry >>= 8;
+                }
+            }
+
+            for (int i = 0; i < len && str[i] == '1'; i++)
+                result[resultlen++] = 0;
+
+            // Poorly coded, but guaranteed to work.
+            for (int i = resultlen - 1, z = (resultlen >> 1) + (resultlen & 1);
+                 i >= z; i--) {
+                int k = result[i];
+                result[i] = result[resultlen - i - 1];
+                result[resultlen - i - 1] = k;
+            }
+        }
+        return resultlen;
+    }
+
+    inline void key_to_account(const std::string &pubkey, std::string &new_account) {
+        std::string pub_wif(pubkey);
+        pub_wif.erase(0, 3); // Remove 'FIO'/'EOS' prefix from wif
+        unsigned char *pub_key_bytes = new unsigned char[37]; // 1 byte head, 256 bit key (32 bytes), 4 bytes checksum (usually)
+        // extract key from wif -- note that if done within EOSIO, this process will be done anyways; just use the pre-decoded pubkey.
+        DecodeBase58(pub_wif.c_str(), pub_wif.length(), pub_key_bytes);
+        uint64_t res = fioio::shorten_key(pub_key_bytes);
+        name tn = name{res};
+        std::string myStr = tn.to_string();
+        //throw an error for safety, since this code was just ported.
+        new_account = myStr.substr(0, 12);
+        delete[] pub_key_bytes;
+    }
+}
+
+namespace {
+    using std::string;
+    using bytes = std::array<unsigned char, fioio::FIOPUBKEYDATALEN>;
+
+    const char *const alphabet = "123456789ABCDEFGHJKLMNPQRSTUVWXYZabcdefghijkmnopqrstuvwxyz";
+
+    //the original DecodeBase58 skipped spaces around the key, the fixed decoder rejects them.
+    bool hasSpace(const string &p) {
+        return std::any_of(p.begin(), p.end(), [](const char c) { return ::isspace((unsigned char) c); });
+    }
+
+    void setChecksum(bytes &data) {
+        capi_checksum160 check;
+        ripemd160(reinterpret_cast<const char *>(data.data()), 33, &check);
+        memcpy(data.data() + 33, check.hash, 4);
+    }
+
+    //the base58 digits of data, left padded with '1' to at least width digits. canonical when width
+    //is 0: one '1' for each leading zero byte.
+    string encode(const bytes &data, const size_t &width) {
+        std::vector<unsigned char> num(data.begin(), data.end());
+        string digits;
+        while (std::any_of(num.begin(), num.end(), [](const unsigned char b) { return b != 0; })) {
+            uint32_t rem = 0;
+            for (auto &b : num) {
+                const uint32_t cur = rem * 256 + b;
+                b = (unsigned char) (cur / 58);
+                rem = cur % 58;
+            }
+            digits.insert(digits.begin(), alphabet[rem]);
+        }
+        size_t zeros = 0;
+        while (zeros < data.size() && data[zeros] == 0) zeros++;
+        const size_t pad = width == 0 ? zeros : (width > digits.size() ? width - digits.size() : 0);
+        return string(pad, '1') + digits;
+    }
+
+    bytes randomKey(std::mt19937_64 &rng) {
+        bytes data;
+        for (auto &b : data) b = (unsigned char) rng();
+        //the head bytes of real keys, and the ones around 0x1d, the largest that fits 50 digits.
+        static const unsigned char heads[] = {0x02, 0x03, 0x00, 0x01, 0x1c, 0x1d, 0x1e};
+        data[0] = heads[rng() % sizeof(heads)];
+        for (size_t z = data[0] == 0 ? rng() % 4 : 0; z > 1; z--) {
+            data[z - 1] = 0;
+        }
+        if (rng() % 4 == 0) data[1] &= 0x7f;
+        setChecksum(data);
+        return data;
+    }
+}
+
+int main() {
+    std::mt19937_64 rng(20201016);
+    const uint64_t keycases = 300000;
+
+    uint64_t cases = 0;
+    uint64_t valid = 0;
+    uint64_t failures = 0;
+    auto compare = [&](const string &p) {
+        const bool expected = !hasSpace(p) && baseline::isPubKeyValid(p);
+        const bool actual = fioio::decode_pubkey(p).valid; //isPubKeyValid
+
+        bool account = true;
+        string expectedaccount;
+        string actualaccount;
+        if (expected) {
+            baseline::key_to_account(p, expectedaccount);
+            fioio::key_to_account(p, actualaccount);
+            account = expectedaccount == actualaccount;
+        }
+
+        cases++;
+        valid += expected;
+        if ((actual != expected || !account) && native_test::count_mismatch(failures)) {
+            printf("mismatch \"%s\": expected %d actual %d account %s/%s\n", p.c_str(), expected, actual,
+                   expectedaccount.c_str(), actualaccount.c_str());
+        }
+    };
+
+    //real keys, a key with a zero head byte, and one whose 50 digits decode to 37 bytes with a zero
+    //head byte but no leading '1', which the original check rejects.
+    for (const char *p : {"FIO7tkpmicyK2YWShSKef6B9XXqBN6LpDJo69oRDfhn67CEnj3L2G",
+                          "FIO5kJKNHwctcfUM5XZyiWSqSTM5HTzznJP9F3ZdbhaQAHEVq575o",
+                          "FIO1bP7yzPZtkUh4wJT9XADntYF7hR82tKjUQSPXz4H4YppEdK4cu",
+                          "FIO2wj5WvHR5sengfHTzZSmxbSHVUPuPcr5U2MUXqs2NkGB3P3Y3w",
+                          "", "FIO", "FIO11111111111111111111111111111111111111111111111111"}) {
+        compare(p);
+    }
+
+    std::vector<string> keys;
+    for (uint64_t i = 0; i < keycases; i++) {
+        const bytes data = randomKey(rng);
+        const string canonical = "FIO" + encode(data, 0);
+        const string padded = "FIO" + encode(data, 50);
+        compare(canonical);
+        compare(padded);
+        if (canonical.size() == fioio::FIOPUBKEYLEN && keys.size() < 1000) {
+            keys.push_back(canonical);
+        }
+
+        string mutated = canonical;
+        switch (rng() % 6) {
+            case 0:
+                mutated[3 + rng() % (mutated.size() - 3)] = alphabet[rng() % 58];
+                break;
+            case 1:
+                mutated.replace(0, 3, "EOS");
+                break;
+            case 2:
+                mutated.erase(3 + rng() % (mutated.size() - 3), 1);
+                break;
+            case 3:
+                mutated.insert(3 + rng() % (mutated.size() - 3), 1, alphabet[rng() % 58]);
+                break;
+            case 4:
+                mutated[3 + rng() % (mutated.size() - 3)] = "0OIl_ +\x80"[rng() % 8];
+                break;
+            default:
+                //a space in place of the first digit, which the original check skipped.
+                mutated = "FIO " + canonical.substr(4);
+                break;
+        }
+        compare(mutated);
+    }
+
+    const int status = native_test::summary("public key validation", cases, failures);
+    printf("public key validation: %llu valid\n", (unsigned long long) valid);
+
+    //the original check against decode_pubkey, over more keys than decode_pubkey keeps.
+    const uint64_t rounds = 200;
+    uint64_t checksum = 0;
+
+    const double oldns = native_test::time_ns([&] {
+        for (uint64_t r = 0; r < rounds; r++) {
+            for (const string &p : keys) {
+                checksum += baseline::isPubKeyValid(p);
+            }
+        }
+    });
+
+    const double newns = native_test::time_ns([&] {
+        for (uint64_t r = 0; r < rounds; r++) {
+            for (const string &p : keys) {
+                checksum += fioio::decode_pubkey(p).valid;
+            }
+        }
+    });
+
+    const double checks = double(rounds * keys.size());
+    printf("public key validation: isPubKeyValid %.1f ns, decode_pubkey %.1f ns per key (checksum %llu)\n",
+           oldns / checks, newns / checks, (unsigned long long) checksum);
+
+    return status == 0 && keys.size() > 0 ? 0 : 1;
+}
@@ -0,0 +1,26 @@
+/** Native stand-in for fio.address.hpp
+ *  Description: the fio.address tables held by the token contract, for the native tests.
+ *  @file fio.address.hpp
+ *  @license FIO Foundation ( https://github.com/fioprotocol/fio/blob/master/LICENSE ) Dapix
+ */
+
+#pragma once
+
+#include <fio.common/fio.common.hpp>
+
+namespace fioio {
+
+    struct fioname {
+        uint64_t id = 0;
+
+        uint64_t primary_key() const { return id; }
+    };
+    typedef multi_index<"fionames"_n, fioname> fionames_table;
+
+    struct eosio_name {
+        uint64_t account = 0;
+
+        uint64_t primary_key() const { return account; }
+    };
+    typedef multi_index<"accountmap"_n, eosio_name> eosio_names_table;
+}
@@ -0,0 +1,30 @@
+/** Native stand-in for fio.common.hpp
+ *  Description: the constants and types of fio.common used by fio.token.hpp, for the native tests.
+ *  @file fio.common.hpp
+ *  @license FIO Foundation ( https://github.com/fioprotocol/fio/blob/master/LICENSE ) Dapix
+ */
+
+#pragma once
+
+#include "../native_eosio.hpp"
+
+#define SECONDSPERDAY  86400
+
+namespace fioio {
+
+    using namespace eosio;
+    using namespace std;
+
+    static const name SYSTEMACCOUNT =    name("eosio");
+    static const name FeeContract =       name("fio.fee");
+    static const name AddressContract =   name("fio.address");
+    static const name TPIDContract =      name("fio.tpid");
+
+    static constexpr eosio::symbol FIOSYMBOL = eosio::symbol("FIO", 9);
+
+    struct config {
+        name tokencontr; // owner of the token contract
+        bool pmtson = true; // enable/disable payments
+    };
+    typedef singleton<"configs"_n, config> configs_singleton;
+}
@@ -0,0 +1,19 @@
+/** Native stand-in for fio.fee.hpp
+ *  Description: the fio.fee table held by the token contract, for the native tests.
+ *  @file fio.fee.hpp
+ *  @license FIO Foundation ( https://github.com/fioprotocol/fio/blob/master/LICENSE ) Dapix
+ */
+
+#pragma once
+
+#include <fio.common/fio.common.hpp>
+
+namespace fioio {
+
+    struct fiofee {
+        uint64_t fee_id = 0;
+
+        uint64_t primary_key() const { return fee_id; }
+    };
+    typedef multi_index<"fiofees"_n, fiofee> fiofee_table;
+}
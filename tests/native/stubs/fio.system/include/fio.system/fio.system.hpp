@@ -0,0 +1,69 @@
+/** Native stand-in for fio.system.hpp
+ *  Description: the genesis and general lock tables of fio.system, for the native tests. the
+ *  rows match the fio.system definitions field for field.
+ *  @file fio.system.hpp
+ *  @license FIO Foundation ( https://github.com/fioprotocol/fio/blob/master/LICENSE ) Dapix
+ */
+
+#pragma once
+
+#include <fio.common/fio.common.hpp>
+
+namespace eosiosystem {
+
+    using eosio::name;
+    using eosio::indexed_by;
+    using eosio::const_mem_fun;
+
+    struct locked_token_holder_info {
+        name owner;
+        uint64_t total_grant_amount = 0;
+        uint32_t unlocked_period_count = 0; //this indicates time periods processed and unlocked thus far.
+        uint32_t grant_type = 0;   //1,2 see FIO spec for details
+        uint32_t inhibit_unlocking = 0;
+        uint64_t remaining_locked_amount = 0;
+        uint32_t timestamp = 0;
+
+        uint64_t primary_key() const { return owner.value; }
+    };
+
+    typedef eosio::multi_index<"lockedtokens"_n, locked_token_holder_info>
+    locked_tokens_table;
+
+    //the balance and token lock rows of a voter, loaded once per voting power refresh,
+    //see eosio::token::get_voting_balance.
+    struct voting_balance {
+        uint64_t balance = 0; //fio balance of the voter.
+        bool genesisfound = false; //the voter has a genesis lock.
+        locked_token_holder_info genesislock; //the genesis lock row (lockedtokens).
+        bool generalfound = false; //the voter has a general lock.
+        int32_t generalcanvote = 0; //can_vote of the general lock.
+        uint64_t generalremaining = 0; //remaining_lock_amount of the general lock.
+    };
+
+    struct lockperiods {
+        int64_t duration = 0; //duration in seconds. each duration is seconds after grant creation.
+        double percent; //this is the percent to be unlocked
+    };
+
+    struct locked_tokens_info {
+        int64_t id; //this is the identifier of the lock, primary key
+        name owner_account; //this is the account that owns the lock, secondary key
+        int64_t lock_amount = 0; //this is the amount of the lock in FIO SUF
+        int32_t payouts_performed = 0; //this is the number of payouts performed thus far.
+        int32_t can_vote = 0; //this is the flag indicating if the lock is votable/proxy-able
+        std::vector<lockperiods> periods;// this is the locking periods for the lock
+        int64_t remaining_lock_amount = 0; //this is the amount remaining in the lock in FIO SUF, get decremented as unlocking occurs.
+        uint32_t timestamp = 0; //this is the time of creation of the lock, locking periods are relative to this time.
+        eosio::binary_extension<std::vector<int64_t>> period_ends; //the period durations sorted, payouts due are found by binary search.
+        eosio::binary_extension<std::vector<uint64_t>> unlocked_amounts; //amount unlocked by periods 0 through i, in period order.
+
+        uint64_t primary_key() const { return id; }
+        uint64_t by_owner() const{return owner_account.value;}
+    };
+
+    typedef eosio::multi_index<"locktokens"_n, locked_tokens_info,
+        indexed_by<"byowner"_n, const_mem_fun < locked_tokens_info, uint64_t, &locked_tokens_info::by_owner> >
+    >
+    general_locks_table;
+}
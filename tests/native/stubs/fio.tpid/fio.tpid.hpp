@@ -0,0 +1,19 @@
+/** Native stand-in for fio.tpid.hpp
+ *  Description: the fio.tpid table held by the token contract, for the native tests.
+ *  @file fio.tpid.hpp
+ *  @license FIO Foundation ( https://github.com/fioprotocol/fio/blob/master/LICENSE ) Dapix
+ */
+
+#pragma once
+
+#include <fio.common/fio.common.hpp>
+
+namespace fioio {
+
+    struct tpid {
+        uint64_t id = 0;
+
+        uint64_t primary_key() const { return id; }
+    };
+    typedef multi_index<"tpids"_n, tpid> tpids_table;
+}
@@ -0,0 +1,374 @@
+/** Native eosio stand-ins
+ *  Description: the small part of eosiolib used by the fio.token lock routines and keyops,
+ *  implemented on the host so those routines can be compiled and run natively. tables live in
+ *  process memory, the clock and the account balances are set by the test.
+ *  @file native_eosio.hpp
+ *  @license FIO Foundation ( https://github.com/fioprotocol/fio/blob/master/LICENSE ) Dapix
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <map>
+#include <optional>
+#include <utility>
+#include <type_traits>
+#include <algorithm>
+#include <stdexcept>
+#include <cstring>
+#include <cassert>
+
+#define EOSLIB_SERIALIZE(TYPE, MEMBERS)
+
+namespace eosio {
+
+    using std::string;
+    using std::vector;
+
+    //raised by check, the test treats it as the action aborting.
+    struct check_failure : std::runtime_error {
+        using std::runtime_error::runtime_error;
+    };
+
+    inline void check(bool pred, const char *msg) {
+        if (!pred) throw check_failure(msg);
+    }
+
+    inline void eosio_assert(bool pred, const char *msg) { check(pred, msg); }
+
+    template<typename... Args>
+    inline void print(Args &&...) {}
+
+    namespace native {
+        inline uint32_t present_time = 0;          //returned by now().
+        inline std::map<uint64_t, int64_t> balances; //fio balance by account, read by the accounts table.
+    }
+
+    inline uint32_t now() { return native::present_time; }
+
+    //names are only compared, any stable hash of the text will do.
+    constexpr uint64_t name_hash(const char *s, std::size_t n) {
+        uint64_t h = 1469598103934665603ULL;
+        for (std::size_t i = 0; i < n; i++) {
+            h = (h ^ (unsigned char) s[i]) * 1099511628211ULL;
+        }
+        return h;
+    }
+
+    constexpr std::size_t name_length(const char *s) {
+        std::size_t n = 0;
+        while (s[n]) n++;
+        return n;
+    }
+
+    struct name {
+        uint64_t value = 0;
+
+        constexpr name() = default;
+
+        constexpr name(uint64_t v) : value(v) {}
+
+        constexpr explicit name(const char *s) : value(name_hash(s, name_length(s))) {}
+
+        constexpr operator uint64_t() const { return value; }
+
+        //the chain's base32 rendering of the value.
+        string to_string() const {
+            static const char *charmap = ".12345abcdefghijklmnopqrstuvwxyz";
+            string str(13, '.');
+            uint64_t tmp = value;
+            for (uint32_t i = 0; i <= 12; ++i) {
+                const char c = charmap[tmp & (i == 0 ? 0x0f : 0x1f)];
+                str[12 - i] = c;
+                tmp >>= (i == 0 ? 4 : 5);
+            }
+            str.erase(str.find_last_not_of('.') + 1);
+            return str;
+        }
+    };
+
+    struct symbol_code {
+        uint64_t value = 0;
+
+        constexpr uint64_t raw() const { return value; }
+    };
+
+    struct symbol {
+        uint64_t value = 0;
+
+        constexpr symbol() = default;
+
+        constexpr symbol(const char *code, uint8_t precision)
+                : value((name_hash(code, name_length(code)) << 8) | precision) {}
+
+        constexpr symbol_code code() const { return symbol_code{value >> 8}; }
+    };
+
+    struct asset {
+        int64_t amount = 0;
+        eosio::symbol symbol;
+    };
+
+    template<typename T>
+    class datastream {
+    };
+
+    class contract {
+    public:
+        contract(name self, name first_receiver, datastream<const char *> ds)
+                : _self(self), _first_receiver(first_receiver), _ds(ds) {}
+
+    protected:
+        name _self;
+        name _first_receiver;
+        datastream<const char *> _ds;
+    };
+
+    template<uint64_t Name, auto Action>
+    struct action_wrapper {
+    };
+
+    template<typename T>
+    class binary_extension {
+        std::optional<T> _value;
+
+    public:
+        bool has_value() const { return _value.has_value(); }
+
+        const T &value() const { return _value.value(); }
+
+        template<typename... Args>
+        void emplace(Args &&... args) { _value.emplace(std::forward<Args>(args)...); }
+    };
+
+    template<uint64_t IndexName, typename Extractor>
+    struct indexed_by {
+        static constexpr uint64_t index_name = IndexName;
+        using extractor = Extractor;
+    };
+
+    template<typename T, typename R, R (T::*Fun)() const>
+    struct const_mem_fun {
+        R operator()(const T &row) const { return (row.*Fun)(); }
+    };
+
+    template<uint64_t IndexName, typename... Indices>
+    struct find_extractor;
+
+    template<uint64_t IndexName, typename First, typename... Rest>
+    struct find_extractor<IndexName, First, Rest...> {
+        using type = std::conditional_t<First::index_name == IndexName, typename First::extractor,
+                typename find_extractor<IndexName, Rest...>::type>;
+    };
+
+    template<uint64_t IndexName>
+    struct find_extractor<IndexName> {
+        using type = void;
+    };
+
+    //rows are kept per table and scope for the life of the process.
+    template<uint64_t TableName, typename T, typename... Indices>
+    class multi_index {
+        using rows_type = std::map<std::pair<uint64_t, uint64_t>, T>;
+
+        static rows_type &rows() {
+            static rows_type r;
+            return r;
+        }
+
+        uint64_t _scope;
+
+    public:
+        class const_iterator {
+            typename rows_type::iterator _itr;
+
+            friend class multi_index;
+
+        public:
+            const_iterator(typename rows_type::iterator itr) : _itr(itr) {}
+
+            const T &operator*() const { return _itr->second; }
+
+            const T *operator->() const { return &_itr->second; }
+
+            const_iterator &operator++() {
+                ++_itr;
+                return *this;
+            }
+
+            bool operator==(const const_iterator &other) const { return _itr == other._itr; }
+
+            bool operator!=(const const_iterator &other) const { return _itr != other._itr; }
+        };
+
+        template<typename Extractor>
+        class secondary_index {
+            const multi_index *_table;
+
+        public:
+            explicit secondary_index(const multi_index *table) : _table(table) {}
+
+            const_iterator find(uint64_t secondary) const {
+                for (auto itr = _table->begin(); itr != _table->end(); ++itr) {
+                    if (Extractor()(*itr) == secondary) return itr;
+                }
+                return _table->end();
+            }
+
+            const_iterator end() const { return _table->end(); }
+
+            template<typename Lambda>
+            void modify(const_iterator itr, name payer, Lambda &&updater) {
+                const_cast<multi_index *>(_table)->modify(itr, payer, std::forward<Lambda>(updater));
+            }
+        };
+
+        multi_index(name code, uint64_t scope) : _scope(scope) {}
+
+        const_iterator begin() const { return rows().lower_bound({_scope, 0}); }
+
+        const_iterator end() const {
+            return _scope == UINT64_MAX ? rows().end() : rows().lower_bound({_scope + 1, 0});
+        }
+
+        const_iterator find(uint64_t primary) const {
+            auto itr = rows().find({_scope, primary});
+            return itr == rows().end() ? end() : const_iterator(itr);
+        }
+
+        const T &get(uint64_t primary, const char *msg = "unable to find key") const {
+            auto itr = find(primary);
+            check(itr != end(), msg);
+            return *itr;
+        }
+
+        const_iterator iterator_to(const T &row) const { return find(row.primary_key()); }
+
+        //unlike the chain an existing row is replaced, so a test can reset a row in place.
+        template<typename Lambda>
+        const_iterator emplace(name payer, Lambda &&constructor) {
+            T row{};
+            constructor(row);
+            return rows().insert_or_assign({_scope, row.primary_key()}, row).first;
+        }
+
+        template<typename Lambda>
+        void modify(const_iterator itr, name payer, Lambda &&updater) {
+            updater(itr._itr->second);
+        }
+
+        const_iterator erase(const_iterator itr) { return rows().erase(itr._itr); }
+
+        template<uint64_t IndexName>
+        secondary_index<typename find_extractor<IndexName, Indices...>::type> get_index() const {
+            return secondary_index<typename find_extractor<IndexName, Indices...>::type>(this);
+        }
+    };
+
+    //the token accounts table holds one row per account, built from native::balances.
+    template<typename T, typename... Indices>
+    class multi_index<name_hash("accounts", 8), T, Indices...> {
+        T _row;
+        bool _found;
+
+    public:
+        multi_index(name code, uint64_t scope)
+                : _row{asset{native::balances.count(scope) ? native::balances.at(scope) : 0, symbol()}},
+                  _found(native::balances.count(scope) > 0) {}
+
+        const T *find(uint64_t) const { return _found ? &_row : end(); }
+
+        const T *end() const { return nullptr; }
+
+        const T &get(uint64_t, const char *msg = "unable to find key") const {
+            check(_found, msg);
+            return _row;
+        }
+    };
+
+    template<uint64_t Name, typename T>
+    class singleton {
+    public:
+        singleton(name code, uint64_t scope) {}
+
+        T get_or_default(const T &def = T()) const { return def; }
+    };
+
+} /// namespace eosio
+
+struct capi_checksum160 {
+    uint8_t hash[20];
+};
+
+//RIPEMD-160 as computed by the chain's ripemd160 intrinsic.
+inline void ripemd160(const char *data, uint32_t length, capi_checksum160 *hash) {
+    static const uint8_t rl[80] = {0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15,
+                                   7, 4, 13, 1, 10, 6, 15, 3, 12, 0, 9, 5, 2, 14, 11, 8,
+                                   3, 10, 14, 4, 9, 15, 8, 1, 2, 7, 0, 6, 13, 11, 5, 12,
+                                   1, 9, 11, 10, 0, 8, 12, 4, 13, 3, 7, 15, 14, 5, 6, 2,
+                                   4, 0, 5, 9, 7, 12, 2, 10, 14, 1, 3, 8, 11, 6, 15, 13};
+    static const uint8_t rr[80] = {5, 14, 7, 0, 9, 2, 11, 4, 13, 6, 15, 8, 1, 10, 3, 12,
+                                   6, 11, 3, 7, 0, 13, 5, 10, 14, 15, 8, 12, 4, 9, 1, 2,
+                                   15, 5, 1, 3, 7, 14, 6, 9, 11, 8, 12, 2, 10, 0, 4, 13,
+                                   8, 6, 4, 1, 3, 11, 15, 0, 5, 12, 2, 13, 9, 7, 10, 14,
+                                   12, 15, 10, 4, 1, 5, 8, 7, 6, 2, 13, 14, 0, 3, 9, 11};
+    static const uint8_t sl[80] = {11, 14, 15, 12, 5, 8, 7, 9, 11, 13, 14, 15, 6, 7, 9, 8,
+                                   7, 6, 8, 13, 11, 9, 7, 15, 7, 12, 15, 9, 11, 7, 13, 12,
+                                   11, 13, 6, 7, 14, 9, 13, 15, 14, 8, 13, 6, 5, 12, 7, 5,
+                                   11, 12, 14, 15, 14, 15, 9, 8, 9, 14, 5, 6, 8, 6, 5, 12,
+                                   9, 15, 5, 11, 6, 8, 13, 12, 5, 12, 13, 14, 11, 8, 5, 6};
+    static const uint8_t sr[80] = {8, 9, 9, 11, 13, 15, 15, 5, 7, 7, 8, 11, 14, 14, 12, 6,
+                                   9, 13, 15, 7, 12, 8, 9, 11, 7, 7, 12, 7, 6, 15, 13, 11,
+                                   9, 7, 15, 11, 8, 6, 6, 14, 12, 13, 5, 14, 13, 13, 7, 5,
+                                   15, 5, 8, 11, 14, 14, 6, 14, 6, 9, 12, 9, 12, 5, 15, 8,
+                                   8, 5, 12, 9, 12, 5, 14, 6, 8, 13, 6, 5, 15, 13, 11, 11};
+    static const uint32_t kl[5] = {0x00000000, 0x5a827999, 0x6ed9eba1, 0x8f1bbcdc, 0xa953fd4e};
+    static const uint32_t kr[5] = {0x50a28be6, 0x5c4dd124, 0x6d703ef3, 0x7a6d76e9, 0x00000000};
+
+    auto rol = [](uint32_t x, uint32_t n) { return (x << n) | (x >> (32 - n)); };
+    auto f = [](uint32_t j, uint32_t x, uint32_t y, uint32_t z) -> uint32_t {
+        switch (j / 16) {
+            case 0: return x ^ y ^ z;
+            case 1: return (x & y) | (~x & z);
+            case 2: return (x | ~y) ^ z;
+            case 3: return (x & z) | (y & ~z);
+            default: return x ^ (y | ~z);
+        }
+    };
+
+    std::vector<uint8_t> msg(data, data + length);
+    msg.push_back(0x80);
+    while (msg.size() % 64 != 56) msg.push_back(0);
+    const uint64_t bits = uint64_t(length) * 8;
+    for (int i = 0; i < 8; i++) msg.push_back(uint8_t(bits >> (8 * i)));
+
+    uint32_t h[5] = {0x67452301, 0xefcdab89, 0x98badcfe, 0x10325476, 0xc3d2e1f0};
+    for (size_t block = 0; block < msg.size(); block += 64) {
+        uint32_t x[16];
+        for (int i = 0; i < 16; i++) {
+            x[i] = uint32_t(msg[block + 4 * i]) | uint32_t(msg[block + 4 * i + 1]) << 8 |
+                   uint32_t(msg[block + 4 * i + 2]) << 16 | uint32_t(msg[block + 4 * i + 3]) << 24;
+        }
+        uint32_t al = h[0], bl = h[1], cl = h[2], dl = h[3], el = h[4];
+        uint32_t ar = h[0], br = h[1], cr = h[2], dr = h[3], er = h[4];
+        for (uint32_t j = 0; j < 80; j++) {
+            uint32_t t = rol(al + f(j, bl, cl, dl) + x[rl[j]] + kl[j / 16], sl[j]) + el;
+            al = el; el = dl; dl = rol(cl, 10); cl = bl; bl = t;
+            t = rol(ar + f(79 - j, br, cr, dr) + x[rr[j]] + kr[j / 16], sr[j]) + er;
+            ar = er; er = dr; dr = rol(cr, 10); cr = br; br = t;
+        }
+        const uint32_t t = h[1] + cl + dr;
+        h[1] = h[2] + dl + er;
+        h[2] = h[3] + el + ar;
+        h[3] = h[4] + al + br;
+        h[4] = h[0] + bl + cr;
+        h[0] = t;
+    }
+    for (int i = 0; i < 20; i++) hash->hash[i] = uint8_t(h[i / 4] >> (8 * (i % 4)));
+}
+
+constexpr uint64_t operator ""_n(const char *s, std::size_t n) {
+    return eosio::name_hash(s, n);
+}